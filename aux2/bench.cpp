@@ -0,0 +1,329 @@
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "containers.hpp"
+#include "ring_buffer.hpp"
+#include "input_map.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <list>
+#include <numeric>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+
+/* casos de aux2_bench.
+ *
+ * Cada grupo de tags mide una parte de aux2; el main (con el modo baseline) está en
+ * bench_main.cpp. Los nombres de los casos son las llaves del JSON de baseline: cambiar uno
+ * invalida los baselines guardados para ese caso.
+ */
+
+namespace {
+
+// Cola con n draw calls de llaves aleatorias (semilla fija para que las corridas sean comparables).
+RenderQueue randomQueue(std::size_t n) {
+    std::mt19937 rng {5512};
+    std::uniform_int_distribution<int> layer {0, 3};
+    std::uniform_int_distribution<int> id {0, 255};
+    std::uniform_real_distribution<float> depth {0.0f, 1.0f};
+    std::bernoulli_distribution translucent {0.1};
+
+    RenderQueue queue;
+    for (std::size_t i = 0; i < n; ++i) {
+        Object mesh = id(rng);
+        Shader program = id(rng);
+        queue.enqueue(mesh, program, makeSortKey(layer(rng), translucent(rng), program, mesh, depth(rng)));
+    }
+    return queue;
+}
+
+// Cuadro "siguiente" al de randomQueue(n): mismas draw calls en el mismo orden salvo un 5% de
+// llaves nuevas (coherente), o las mismas draw calls en orden aleatorio.
+std::vector<DrawCall> nextFrame(const RenderQueue& previous, bool coherent) {
+    std::mt19937 rng {1234};
+    std::vector<DrawCall> calls(previous.drawCalls());
+    if (coherent) {
+        std::uniform_int_distribution<SortKey> key;
+        for (std::size_t i = 0; i < calls.size() / 20; ++i)
+            calls[rng() % calls.size()].key = key(rng);
+    } else {
+        std::shuffle(calls.begin(), calls.end(), rng);
+    }
+    return calls;
+}
+
+// Cola con un cuadro ya ordenado en el modo dado (para que el modo incremental tenga su
+// permutación) y el cuadro siguiente encolado, listo para sort().
+RenderQueue primedQueue(std::size_t n, SortMode mode, bool coherent) {
+    RenderQueue queue = randomQueue(n);
+    const auto next = nextFrame(queue, coherent);
+
+    queue.setSortMode(mode);
+    queue.sort();
+    queue.clear();
+    for (const auto& call : next)
+        queue.enqueue(call.object, call.shader, call.key);
+    return queue;
+}
+
+// La cola productor-consumidor "ingenua": std::deque protegido por un mutex.
+template <typename T>
+class LockedDeque {
+public:
+    explicit LockedDeque(std::size_t) {}
+
+    std::size_t tryPush(const T* items, std::size_t count) {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_deque.insert(m_deque.end(), items, items + count);
+        return count;
+    }
+
+    std::size_t tryPop(T* items, std::size_t count) {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        const std::size_t n = std::min(count, m_deque.size());
+        std::copy_n(m_deque.begin(), n, items);
+        m_deque.erase(m_deque.begin(), m_deque.begin() + n);
+        return n;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::deque<T> m_deque;
+};
+
+// Transfiere `items` enteros de `producers` hilos a `consumers` hilos en lotes de `batch`.
+template <typename Queue>
+void transfer(std::size_t items, int producers, int consumers, std::size_t batch) {
+    Queue queue {1024};
+    std::atomic<std::size_t> popped {0};
+    const std::size_t per_producer = items / producers;
+    const std::size_t total = per_producer * producers;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, per_producer, batch]() {
+            std::vector<int> buffer(batch, 1);
+            for (std::size_t sent = 0; sent < per_producer;) {
+                const std::size_t n = queue.tryPush(buffer.data(), std::min(batch, per_producer - sent));
+                sent += n;
+                if (n == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue, &popped, total, batch]() {
+            std::vector<int> buffer(batch);
+            while (popped.load(std::memory_order_relaxed) < total) {
+                const std::size_t n = queue.tryPop(buffer.data(), batch);
+                popped += n;
+                if (n == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+}
+
+// Ida y vuelta de un mensaje entre dos hilos; mide la latencia de una cola en ambos sentidos.
+template <typename Queue>
+void pingPong(Catch::Benchmark::Chronometer meter) {
+    Queue ping {64};
+    Queue pong {64};
+    std::atomic<bool> done {false};
+
+    std::thread echo([&]() {
+        int value;
+        while (!done.load(std::memory_order_relaxed)) {
+            if (ping.tryPop(&value, 1))
+                while (!pong.tryPush(&value, 1))
+                    std::this_thread::yield();
+            else
+                std::this_thread::yield();
+        }
+    });
+
+    meter.measure([&](int i) {
+        int value = i;
+        while (!ping.tryPush(&value, 1))
+            std::this_thread::yield();
+        while (!pong.tryPop(&value, 1))
+            std::this_thread::yield();
+        return value;
+    });
+
+    done = true;
+    echo.join();
+}
+
+}
+
+TEST_CASE("RenderQueue", "[render_queue]") {
+    for (std::size_t n : {1'000, 10'000, 100'000}) {
+        const RenderQueue queue = randomQueue(n);
+        const std::vector<DrawCall> calls = queue.drawCalls();
+        const std::string size = std::to_string(n);
+
+        // con la capacidad ya reservada por cuadros anteriores (régimen estacionario).
+        RenderQueue reused = queue;
+        BENCHMARK("enqueue " + size) {
+            reused.clear();
+            for (const auto& call : calls)
+                reused.enqueue(call.object, call.shader, call.key);
+            return reused.drawCalls().size();
+        };
+
+        BENCHMARK_ADVANCED("sort " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<RenderQueue> queues(meter.runs(), queue);
+            meter.measure([&queues](int i) { queues[i].sort(); });
+        };
+
+        // clear() no depende del tamaño, así que Catch pide millones de corridas y no caben
+        // tantas copias llenas: se usa un pool acotado y las vueltas siguientes vacían colas
+        // vacías, que cuesta lo mismo (ver el static_assert en containers.cpp).
+        BENCHMARK_ADVANCED("clear " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<RenderQueue> queues(std::min(meter.runs(), 64), queue);
+            meter.measure([&queues](int i) { queues[i % queues.size()].clear(); });
+        };
+
+        std::list<int> list(n);
+        std::iota(list.begin(), list.end(), 0);
+        BENCHMARK("invertir " + size) {
+            return invertir(list);
+        };
+    }
+}
+
+TEST_CASE("RenderQueue::sort vs std::sort", "[sort]") {
+    for (std::size_t n : {10'000, 100'000, 1'000'000}) {
+        const RenderQueue queue = randomQueue(n);
+        const std::string size = std::to_string(n);
+
+        // sort() además de ordenar une los buckets de los productores y arma los batches; el
+        // caso std::sort ordena solo las llaves, así que la diferencia subestima al radix.
+        BENCHMARK_ADVANCED("RenderQueue::sort (radix + batches) " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<RenderQueue> queues(meter.runs(), queue);
+            meter.measure([&queues](int i) { queues[i].sort(); });
+        };
+
+        BENCHMARK_ADVANCED("std::sort (solo llaves) " + size)(Catch::Benchmark::Chronometer meter) {
+            std::vector<std::vector<DrawCall>> calls(meter.runs(), queue.drawCalls());
+            meter.measure([&calls](int i) {
+                std::sort(calls[i].begin(), calls[i].end(),
+                          [](const DrawCall& a, const DrawCall& b) { return a.key < b.key; });
+            });
+        };
+    }
+}
+
+TEST_CASE("RenderQueue incremental sort", "[sort][incremental]") {
+    for (std::size_t n : {100'000, 1'000'000}) {
+        for (bool coherent : {true, false}) {
+            const std::string name = (coherent ? "coherent " : "shuffled ") + std::to_string(n);
+
+            const RenderQueue radix = primedQueue(n, SortMode::Radix, coherent);
+            const RenderQueue incremental = primedQueue(n, SortMode::Incremental, coherent);
+
+            BENCHMARK_ADVANCED("radix " + name)(Catch::Benchmark::Chronometer meter) {
+                std::vector<RenderQueue> queues(meter.runs(), radix);
+                meter.measure([&queues](int i) { queues[i].sort(); });
+            };
+
+            BENCHMARK_ADVANCED("incremental " + name)(Catch::Benchmark::Chronometer meter) {
+                std::vector<RenderQueue> queues(meter.runs(), incremental);
+                meter.measure([&queues](int i) { queues[i].sort(); });
+            };
+        }
+    }
+}
+
+TEST_CASE("Producer-consumer queues", "[queue]") {
+    constexpr std::size_t items = 1'000'000;
+
+    for (std::size_t batch : {1, 64}) {
+        const std::string suffix = " x" + std::to_string(batch);
+
+        BENCHMARK("throughput 1P1C spsc" + suffix) {
+            transfer<SpscRingBuffer<int>>(items, 1, 1, batch);
+        };
+        BENCHMARK("throughput 1P1C mpmc" + suffix) {
+            transfer<MpmcRingBuffer<int>>(items, 1, 1, batch);
+        };
+        BENCHMARK("throughput 1P1C deque+mutex" + suffix) {
+            transfer<LockedDeque<int>>(items, 1, 1, batch);
+        };
+        BENCHMARK("throughput 4P4C mpmc" + suffix) {
+            transfer<MpmcRingBuffer<int>>(items, 4, 4, batch);
+        };
+        BENCHMARK("throughput 4P4C deque+mutex" + suffix) {
+            transfer<LockedDeque<int>>(items, 4, 4, batch);
+        };
+    }
+
+    BENCHMARK_ADVANCED("latency round trip spsc")(Catch::Benchmark::Chronometer meter) {
+        pingPong<SpscRingBuffer<int>>(meter);
+    };
+    BENCHMARK_ADVANCED("latency round trip mpmc")(Catch::Benchmark::Chronometer meter) {
+        pingPong<MpmcRingBuffer<int>>(meter);
+    };
+    BENCHMARK_ADVANCED("latency round trip deque+mutex")(Catch::Benchmark::Chronometer meter) {
+        pingPong<LockedDeque<int>>(meter);
+    };
+}
+
+TEST_CASE("InputMap dispatch", "[input]") {
+    // muchas acciones con pocos callbacks cada una, como un overlay de herramientas.
+    constexpr int bindings = 5000;
+    constexpr int events = 4096;
+
+    std::mt19937 rng {7};
+    std::uniform_int_distribution<Input> input {0, bindings};
+
+    std::size_t counter = 0;
+    auto callback = [&counter](Input, Action) { ++counter; };
+
+    InputMap flat;
+    std::multimap<Input, Action> input_actions;
+    std::multimap<Action, InputCallback> action_callbacks;
+    for (int i = 0; i < bindings; ++i) {
+        const Input in = input(rng);
+        const Action action = i;
+        flat.bind(in, action);
+        flat.addCallback(action, callback);
+        input_actions.emplace(in, action);
+        action_callbacks.emplace(action, callback);
+    }
+    flat.build();
+
+    std::vector<Input> polled(events);
+    for (auto& in : polled)
+        in = input(rng);
+
+    BENCHMARK("flat InputMap " + std::to_string(events) + " events") {
+        return flat.dispatch(polled.data(), polled.size());
+    };
+
+    BENCHMARK("std::multimap " + std::to_string(events) + " events") {
+        std::size_t invoked = 0;
+        for (Input in : polled) {
+            auto actions = input_actions.equal_range(in);
+            for (auto a = actions.first; a != actions.second; ++a) {
+                auto callbacks = action_callbacks.equal_range(a->second);
+                for (auto c = callbacks.first; c != callbacks.second; ++c, ++invoked)
+                    c->second(in, a->second);
+            }
+        }
+        return invoked;
+    };
+
+    const auto& stats = flat.stats();
+    std::cout << "InputMap: " << stats.events << " events, " << stats.callbacks << " callbacks, "
+              << stats.nanosecondsPerEvent() << " ns/event\n";
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#define CATCH_CONFIG_RUNNER
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+
+/* main de aux2_bench.
+ *
+ * Además de las opciones de Catch acepta:
+ *   --save-baseline <archivo>   guarda el promedio de cada benchmark en un JSON.
+ *   --baseline <archivo>        compara contra un JSON guardado antes; el programa falla si
+ *                               algún benchmark es más de --max-regression % más lento.
+ *   --max-regression <porcentaje>  tolerancia, 10 por defecto.
+ *
+ * El JSON es un objeto plano { "nombre del benchmark": promedio en ns, ... }.
+ */
+
+namespace {
+
+using Results = std::map<std::string, double>;
+
+Results results;
+
+// Guarda el promedio (en ns) de cada benchmark que termina.
+class ResultListener : public Catch::TestEventListenerBase {
+public:
+    using TestEventListenerBase::TestEventListenerBase;
+
+    void benchmarkEnded(Catch::BenchmarkStats<> const& stats) override {
+        results[stats.info.name] = stats.mean.point.count();
+    }
+};
+
+std::string escape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void saveBaseline(const std::string& path, const Results& values) {
+    std::ofstream file {path};
+    file << "{\n" << std::setprecision(10);
+    for (auto it = values.begin(); it != values.end(); ++it) {
+        file << "  \"" << escape(it->first) << "\": " << it->second;
+        file << (std::next(it) == values.end() ? "\n" : ",\n");
+    }
+    file << "}\n";
+}
+
+// Lee el objeto plano que escribe saveBaseline(); no es un parser de JSON general.
+bool loadBaseline(const std::string& path, Results& values) {
+    std::ifstream file {path};
+    if (!file)
+        return false;
+    const std::string text = (std::stringstream() << file.rdbuf()).str();
+
+    std::size_t i = text.find('{');
+    if (i == std::string::npos)
+        return false;
+
+    while (true) {
+        i = text.find_first_of("\"}", i + 1);
+        if (i == std::string::npos)
+            return false;
+        if (text[i] == '}')
+            return true;
+
+        std::string name;
+        for (++i; i < text.size() && text[i] != '"'; ++i) {
+            if (text[i] == '\\')
+                ++i;
+            name += text[i];
+        }
+
+        i = text.find(':', i);
+        if (i == std::string::npos)
+            return false;
+
+        const char* start = text.c_str() + i + 1;
+        char* end;
+        const double value = std::strtod(start, &end);
+        if (end == start)
+            return false;
+        values[name] = value;
+        i += end - start;
+    }
+}
+
+// Imprime la comparación y retorna cuántos benchmarks empeoraron más que la tolerancia.
+int compareBaseline(const Results& baseline, const Results& current, double max_regression) {
+    int regressions = 0;
+
+    std::cout << "\nComparación con el baseline (tolerancia " << max_regression << "%)\n";
+    for (const auto& [name, mean] : current) {
+        std::cout << "  " << std::left << std::setw(48) << name << std::right;
+
+        auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            std::cout << "       (nuevo)\n";
+            continue;
+        }
+
+        const double change = (mean / it->second - 1.0) * 100.0;
+        std::cout << std::showpos << std::fixed << std::setprecision(1) << std::setw(10) << change << "%"
+                  << std::noshowpos << std::defaultfloat;
+        if (change > max_regression) {
+            std::cout << "  REGRESIÓN";
+            ++regressions;
+        }
+        std::cout << '\n';
+    }
+
+    return regressions;
+}
+
+}
+
+CATCH_REGISTER_LISTENER(ResultListener)
+
+int main(int argc, char* argv[]) {
+    Catch::Session session;
+
+    std::string baseline_path;
+    std::string save_path;
+    double max_regression = 10.0;
+
+    using Catch::clara::Opt;
+    session.cli(session.cli()
+                | Opt(baseline_path, "archivo")["--baseline"]
+                        ("falla si algún benchmark es más lento que en este baseline JSON")
+                | Opt(save_path, "archivo")["--save-baseline"]
+                        ("guarda los resultados como baseline JSON")
+                | Opt(max_regression, "porcentaje")["--max-regression"]
+                        ("regresión tolerada respecto al baseline (10 por defecto)"));
+
+    int status = session.applyCommandLine(argc, argv);
+    if (status != 0)
+        return status;
+
+    status = session.run();
+
+    if (!save_path.empty())
+        saveBaseline(save_path, results);
+
+    if (!baseline_path.empty()) {
+        Results baseline;
+        if (!loadBaseline(baseline_path, baseline)) {
+            std::cerr << "No se pudo leer el baseline " << baseline_path << '\n';
+            return 1;
+        }
+        if (compareBaseline(baseline, results, max_regression) > 0 && status == 0)
+            status = 1;
+    }
+
+    return status;
+}
\ No newline at end of file
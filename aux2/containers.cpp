@@ -1,28 +1,419 @@
 #include "containers.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+
+
+// Sort keys
+
+namespace {
+
+constexpr unsigned layer_bits = 7;
+constexpr unsigned program_bits = 16;
+constexpr unsigned mesh_bits = 16;
+constexpr unsigned depth_bits = 24;
+
+constexpr SortKey mask(unsigned bits) {
+    return (SortKey {1} << bits) - 1;
+}
+
+SortKey quantizeDepth(float depth) {
+    // NaN pasa por std::clamp y convertirlo a entero es UB: cuenta como profundidad 0.
+    if (!(depth >= 0.0f))
+        depth = 0.0f;
+    depth = std::clamp(depth, 0.0f, 1.0f);
+    return static_cast<SortKey>(depth * float(mask(depth_bits)));
+}
+
+// un int con el bit de signo invertido ordena como entero sin signo igual que el int original.
+SortKey biased(int value) {
+    return static_cast<std::uint32_t>(value) ^ 0x8000'0000u;
+}
+
+// llave de enqueue(obj, shader): shader en los 32 bits altos y objeto en los bajos.
+SortKey shaderKey(Shader shader, Object object) {
+    return biased(shader) << 32 | biased(object);
+}
+
+}
+
+SortKey makeSortKey(unsigned layer, bool translucent, Shader program, Object mesh, float depth) {
+    assert(layer <= mask(layer_bits));
+    assert(program >= 0 && SortKey(program) <= mask(program_bits));
+    assert(mesh >= 0 && SortKey(mesh) <= mask(mesh_bits));
+
+    const SortKey l = SortKey {layer} & mask(layer_bits);
+    const SortKey p = static_cast<SortKey>(program) & mask(program_bits);
+    const SortKey m = static_cast<SortKey>(mesh) & mask(mesh_bits);
+    const SortKey d = quantizeDepth(depth);
+
+    SortKey key = l << 57;
+    if (translucent)
+        key |= SortKey {1} << 56 | (~d & mask(depth_bits)) << 32 | p << 16 | m;
+    else
+        key |= p << 40 | m << 24 | d;
+    return key;
+}
+
 
 // RenderQueue
 
+namespace {
+
+/* radix sort LSD, 8 bits por pasada.
+ *
+ * Los 8 histogramas se calculan en un solo recorrido. Las pasadas en que todas las llaves
+ * comparten el mismo dígito no cambian el orden y se omiten, así que llaves que solo usan
+ * algunos campos (p. ej. sin profundidad) cuestan menos de 8 pasadas.
+ */
+template <typename T>
+void radixSort(std::vector<T>& data, std::vector<T>& scratch) {
+    constexpr unsigned radix_bits = 8;
+    constexpr unsigned buckets = 1u << radix_bits;
+    constexpr unsigned passes = sizeof(SortKey) * 8 / radix_bits;
+
+    const std::size_t n = data.size();
+    if (n < 2)
+        return;
+
+    std::array<std::array<std::size_t, buckets>, passes> histograms {};
+    for (const T& item : data)
+        for (unsigned pass = 0; pass < passes; ++pass)
+            ++histograms[pass][(item.key >> (pass * radix_bits)) & (buckets - 1)];
+
+    scratch.resize(n);
+
+    for (unsigned pass = 0; pass < passes; ++pass) {
+        auto& counts = histograms[pass];
+        const unsigned shift = pass * radix_bits;
+
+        if (counts[(data[0].key >> shift) & (buckets - 1)] == n)
+            continue;
+
+        std::size_t offset = 0;
+        for (auto& count : counts) {
+            const std::size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for (const T& item : data)
+            scratch[counts[(item.key >> shift) & (buckets - 1)]++] = item;
+
+        data.swap(scratch);
+    }
+}
+
+// Redimensiona v y cuenta una asignación si tuvo que crecer.
+template <typename T>
+void resizeCounted(std::vector<T>& v, std::size_t n, std::size_t& allocations) {
+    allocations += n > v.capacity();
+    v.resize(n);
+}
+
+}
+
+// PayloadArena
+
+Payload PayloadArena::allocate(std::size_t size, std::size_t align) {
+    const std::size_t offset = (m_bytes.size() + align - 1) / align * align;
+    const auto capacity = m_bytes.capacity();
+    m_bytes.resize(offset + size);
+    m_allocations += m_bytes.capacity() != capacity;
+    return Payload(offset);
+}
+
+Payload PayloadArena::append(const PayloadArena& other) {
+    if (other.m_bytes.empty())
+        return Payload(m_bytes.size());
+    const Payload base = allocate(other.size(), alignof(std::max_align_t));
+    std::copy(other.m_bytes.begin(), other.m_bytes.end(), m_bytes.begin() + base);
+    return base;
+}
+
+
+// clear() es O(1) solo si vaciar el vector no tiene que destruir elemento por elemento.
+static_assert(std::is_trivially_destructible_v<DrawCall>);
+
+RenderQueue::RenderQueue(std::size_t frames) :
+m_frames(std::max<std::size_t>(frames, 1)),
+m_submitted(m_frames.size() - 1)
+{}
+
+void RenderQueue::beginFrame() {
+    m_recording = (m_submitted + 1) % m_frames.size();
+    clear();
+}
+
+RenderQueue::SubmittedFrame RenderQueue::endFrame() {
+    sort();
+    m_submitted = m_recording;
+    return SubmittedFrame {m_frames[m_submitted]};
+}
+
+const std::vector<DrawCall>& RenderQueue::SubmittedFrame::calls() const {
+    return m_frame->calls;
+}
+
+const std::vector<DrawBatch>& RenderQueue::SubmittedFrame::batches() const {
+    return m_frame->batches;
+}
+
+const std::vector<Instance>& RenderQueue::SubmittedFrame::instances() const {
+    return m_frame->instances;
+}
+
+const std::byte* RenderQueue::SubmittedFrame::payloadData(Payload payload) const {
+    return m_frame->arena.data(payload);
+}
+
+const std::vector<DrawCall>& RenderQueue::submitted() const {
+    return m_frames[m_submitted].calls;
+}
+
+const std::vector<DrawBatch>& RenderQueue::submittedBatches() const {
+    return m_frames[m_submitted].batches;
+}
+
+const std::vector<Instance>& RenderQueue::submittedInstances() const {
+    return m_frames[m_submitted].instances;
+}
+
+std::size_t RenderQueue::allocationCount() const {
+    std::size_t count = m_allocations;
+    for (const auto& frame : m_frames)
+        count += frame.arena.allocations();
+    for (const auto& bucket : m_buckets)
+        count += bucket.allocations + bucket.arena.allocations();
+    return count;
+}
+
+RenderQueue::Frame& RenderQueue::recording() {
+    return m_frames[m_recording];
+}
+
+void RenderQueue::Recorder::enqueue(Object object, Shader shader) {
+    enqueue(object, shader, shaderKey(shader, object));
+}
+
+void RenderQueue::Recorder::enqueue(Object object, Shader shader, SortKey key, Instance instance, Payload payload) {
+    auto& calls = m_bucket->calls;
+    const auto capacity = calls.capacity();
+    calls.push_back({object, shader, key, instance, payload});
+    m_bucket->allocations += calls.capacity() != capacity;
+}
+
+Payload RenderQueue::Recorder::allocatePayload(std::size_t size, std::size_t align) {
+    return m_bucket->arena.allocate(size, align);
+}
+
+std::byte* RenderQueue::Recorder::payloadData(Payload payload) {
+    return m_bucket->arena.data(payload);
+}
+
+void RenderQueue::beginRecording(std::size_t producers) {
+    mergeBuckets();
+    const auto capacity = m_buckets.capacity();
+    m_buckets.resize(producers);
+    m_allocations += m_buckets.capacity() != capacity;
+}
+
+RenderQueue::Recorder RenderQueue::recorder(std::size_t producer) {
+    return Recorder {m_buckets.at(producer)};
+}
+
+void RenderQueue::mergeBuckets() {
+    auto& frame = recording();
+    auto& calls = frame.calls;
+
+    std::size_t total = calls.size();
+    for (const auto& bucket : m_buckets)
+        total += bucket.calls.size();
+
+    if (total > calls.capacity()) {
+        calls.reserve(total);
+        ++m_allocations;
+    }
+
+    for (auto& bucket : m_buckets) {
+        // los offsets del bucket pasan a ser relativos a la arena del cuadro.
+        const Payload base = frame.arena.append(bucket.arena);
+        for (DrawCall call : bucket.calls) {
+            if (call.payload != no_payload)
+                call.payload += base;
+            calls.push_back(call);
+        }
+        bucket.calls.clear();
+        bucket.arena.reset();
+    }
+}
+
 void RenderQueue::enqueue(Object object, Shader shader) {
-    return;
+    enqueue(object, shader, shaderKey(shader, object));
+}
+
+void RenderQueue::enqueue(Object object, Shader shader, SortKey key, Instance instance, Payload payload) {
+    auto& calls = recording().calls;
+    const auto capacity = calls.capacity();
+    calls.push_back({object, shader, key, instance, payload});
+    m_allocations += calls.capacity() != capacity;
+}
+
+Payload RenderQueue::allocatePayload(std::size_t size, std::size_t align) {
+    return recording().arena.allocate(size, align);
+}
+
+std::byte* RenderQueue::payloadData(Payload payload) {
+    return recording().arena.data(payload);
+}
+
+const std::byte* RenderQueue::payloadData(Payload payload) const {
+    return m_frames[m_recording].arena.data(payload);
+}
+
+const std::byte* RenderQueue::submittedPayloadData(Payload payload) const {
+    return m_frames[m_submitted].arena.data(payload);
 }
 
 const std::vector<DrawCall>& RenderQueue::drawCalls() const{
-    static std::vector<DrawCall> vec {};
-    return vec;
+    return m_frames[m_recording].calls;
 }
 
-void RenderQueue::clear() {
+const std::vector<DrawBatch>& RenderQueue::batches() const {
+    return m_frames[m_recording].batches;
+}
+
+const std::vector<Instance>& RenderQueue::instances() const {
+    return m_frames[m_recording].instances;
+}
+
+BatchStats RenderQueue::batchStats() const {
+    const auto& frame = m_frames[m_recording];
+    const std::size_t batches = frame.batches.size();
+    return {batches, batches ? double(frame.instances.size()) / double(batches) : 0.0};
+}
 
+void RenderQueue::clear() {
+    auto& frame = recording();
+    frame.calls.clear();
+    frame.batches.clear();
+    frame.instances.clear();
+    frame.arena.reset();
+    for (auto& bucket : m_buckets) {
+        bucket.calls.clear();
+        bucket.arena.reset();
+    }
 }
 
 void RenderQueue::sort() {
+    mergeBuckets();
+
+    auto& calls = recording().calls;
+    if (m_sort_mode == SortMode::Incremental) {
+        incrementalSort();
+    } else {
+        if (calls.size() > 1 && m_scratch.capacity() < calls.size())
+            ++m_allocations;
+        radixSort(calls, m_scratch);
+    }
+
+    buildBatches();
+}
+
+void RenderQueue::setSortMode(SortMode mode) {
+    m_sort_mode = mode;
+    m_order.clear();
+}
+
+void RenderQueue::incrementalSort() {
+    auto& calls = recording().calls;
+    const std::size_t n = calls.size();
+
+    // 1. orden sugerido: la permutación anterior, sin los índices que ya no existen,
+    //    seguida de las draw calls nuevas.
+    resizeCounted(m_keys, n, m_allocations);
+    std::size_t count = 0;
+    for (std::uint32_t index : m_order)
+        if (index < n)
+            m_keys[count++] = {calls[index].key, index};
+    for (std::size_t index = m_order.size(); index < n; ++index)
+        m_keys[count++] = {calls[index].key, std::uint32_t(index)};
+
+    // 2. split: se conserva una subsecuencia ordenada (compactada en el mismo arreglo) y cada
+    //    elemento que rompe el orden sale junto con el último conservado, que podría ser el
+    //    culpable. Lo que sale es a lo más el doble de los elementos realmente desordenados.
+    resizeCounted(m_keys_rest, n, m_allocations);
+    std::size_t kept = 0;
+    std::size_t rest = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (kept == 0 || m_keys[kept - 1].key <= m_keys[i].key) {
+            m_keys[kept++] = m_keys[i];
+        } else {
+            m_keys_rest[rest++] = m_keys[--kept];
+            m_keys_rest[rest++] = m_keys[i];
+        }
+    }
+
+    // 3. si la entrada venía casi ordenada, se ordena solo el resto y se mezcla; si no, radix.
+    if (rest > n / 4) {
+        std::copy_n(m_keys_rest.begin(), rest, m_keys.begin() + kept);
+        if (n > 1 && m_keys_scratch.capacity() < n)
+            ++m_allocations;
+        radixSort(m_keys, m_keys_scratch);
+    } else if (rest > 0) {
+        m_keys_rest.resize(rest);
+        m_keys.resize(kept);
+        radixSort(m_keys_rest, m_keys_scratch);
+
+        resizeCounted(m_keys_scratch, n, m_allocations);
+        std::merge(m_keys.begin(), m_keys.end(), m_keys_rest.begin(), m_keys_rest.end(), m_keys_scratch.begin(),
+                   [](const KeyIndex& a, const KeyIndex& b) { return a.key < b.key; });
+        m_keys.swap(m_keys_scratch);
+    }
+
+    // 4. aplicar la permutación y guardarla para el próximo cuadro.
+    resizeCounted(m_scratch, n, m_allocations);
+    resizeCounted(m_order, n, m_allocations);
+    for (std::size_t i = 0; i < n; ++i) {
+        m_scratch[i] = calls[m_keys[i].index];
+        m_order[i] = m_keys[i].index;
+    }
+    calls.swap(m_scratch);
+}
+
+void RenderQueue::buildBatches() {
+    auto& frame = recording();
+    const auto& calls = frame.calls;
+    auto& batches = frame.batches;
+    auto& instances = frame.instances;
+
+    const auto instances_capacity = instances.capacity();
+
+    batches.clear();
+    instances.resize(calls.size());
+
+    for (std::size_t i = 0; i < calls.size(); ++i) {
+        const DrawCall& call = calls[i];
+        instances[i] = call.instance;
+
+        if (!batches.empty() && batches.back().object == call.object && batches.back().shader == call.shader)
+            ++batches.back().count;
+        else {
+            const auto capacity = batches.capacity();
+            batches.push_back({call.object, call.shader, std::uint32_t(i), 1});
+            m_allocations += batches.capacity() != capacity;
+        }
+    }
 
+    m_allocations += instances.capacity() != instances_capacity;
 }
 
 
 // invertir
 
 std::list<int> invertir(const std::list<int>& l) {
-    return {};
+    return {l.rbegin(), l.rend()};
 }
\ No newline at end of file
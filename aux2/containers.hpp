@@ -3,6 +3,10 @@
 
 #include <vector>
 #include <list>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 
 /* invertir
@@ -23,21 +27,296 @@ std::list<int> invertir(const std::list<int>& l);
 using Object = int;
 using Shader = int;
 
+/* llave de ordenamiento.
+ *
+ * Empaqueta en 64 bits todo lo que determina el orden de una draw call, de modo que ordenar
+ * la cola se reduce a ordenar enteros. De los bits más significativos a los menos:
+ *
+ *   opaco:       layer (7) | 0 | programa (16) | malla (16) | profundidad (24)
+ *   translúcido: layer (7) | 1 | ~profundidad (24) | programa (16) | malla (16)
+ *
+ * Los objetos opacos se agrupan por programa y luego por malla (minimiza cambios de estado),
+ * y se dibujan de adelante hacia atrás. Los translúcidos van después, de atrás hacia adelante.
+ * La profundidad se espera normalizada en [0, 1]; fuera de rango se satura y NaN vale 0.
+ * El objeto de la draw call hace de malla. layer va en [0, 128) y programa y malla en
+ * [0, 65536): valores fuera de rango chocarían con otros ids (se verifica con assert).
+ *
+ * enqueue(obj, shader) sin llave no usa makeSortKey: ordena por shader y luego por objeto
+ * con el orden completo de int (negativos primero), sin límite de rango. Esas llaves no se
+ * deben mezclar en una misma cola con las de makeSortKey.
+ */
+
+using SortKey = std::uint64_t;
+
+SortKey makeSortKey(unsigned layer, bool translucent, Shader program, Object mesh, float depth);
+
+// dato por instancia que acompaña a la draw call (p. ej. índice de su transformación).
+using Instance = std::uint32_t;
+
+// offset del payload de una draw call dentro de la arena de su cuadro.
+using Payload = std::uint32_t;
+constexpr Payload no_payload = ~Payload {0};
+
 struct DrawCall {
     Object object;
     Shader shader;
+    SortKey key;
+    Instance instance;
+    Payload payload;
+};
+
+/* arena lineal.
+ *
+ * Guarda los payloads (matriz, color, parámetros del material...) de las draw calls de un
+ * cuadro en un solo bloque contiguo: allocate() solo avanza un offset y reset() vuelve a cero
+ * sin liberar memoria. Las draw calls guardan el offset y no un puntero, así que ordenar mueve
+ * solo llaves y offsets, y la arena puede crecer (y moverse) sin invalidar nada. Se aceptan
+ * alineamientos de hasta alignof(std::max_align_t).
+ */
+class PayloadArena {
+public:
+    Payload allocate(std::size_t size, std::size_t align);
+
+    std::byte* data(Payload offset) { return m_bytes.data() + offset; }
+    const std::byte* data(Payload offset) const { return m_bytes.data() + offset; }
+
+    std::size_t size() const { return m_bytes.size(); }
+    std::size_t allocations() const { return m_allocations; }
+
+    void reset() { m_bytes.clear(); }
+
+    // copia el contenido de other al final; retorna el offset donde quedó.
+    Payload append(const PayloadArena& other);
+
+private:
+    std::vector<std::byte> m_bytes;
+    std::size_t m_allocations {0};
+};
+
+/* batch de instancias.
+ *
+ * Draw calls consecutivas (ya ordenadas) con el mismo shader y la misma malla se juntan en un
+ * batch que se puede dibujar con una sola llamada instanciada. [first, first + count) es el
+ * rango del batch en RenderQueue::instances(), que guarda DrawCall::instance en orden.
+ */
+struct DrawBatch {
+    Object object;
+    Shader shader;
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+struct BatchStats {
+    std::size_t batches;
+    double average_size;
+};
+
+/* modo de ordenamiento.
+ *
+ * Radix: radix sort completo en cada sort().
+ * Incremental: aprovecha que de un cuadro a otro la lista cambia poco. Aplica la permutación
+ * del sort() anterior a las draw calls actuales (si se encolan en el mismo orden, el resultado
+ * queda casi ordenado), separa los elementos fuera de orden, ordena solo esos y los mezcla con
+ * el resto. Si hay demasiados fuera de orden vuelve al radix sort. El orden entre llaves
+ * iguales puede diferir del modo Radix.
+ */
+enum class SortMode {
+    Radix,
+    Incremental
 };
 
 class RenderQueue {
+    struct Bucket;
+    struct Frame;
 public:
+    /* pipeline de cuadros.
+     *
+     * Con frames > 1 la cola mantiene varios buffers: beginFrame() pasa al siguiente y lo vacía,
+     * endFrame() lo ordena y lo publica en submitted(). Así se puede grabar el cuadro N+1
+     * mientras otro hilo consume el cuadro N; con frames == 2 el consumo del cuadro N debe
+     * terminar antes del beginFrame() del cuadro N+2. enqueue(), sort(), clear() y drawCalls()
+     * operan sobre el cuadro en grabación. Con frames == 1 no hace falta llamar beginFrame().
+     *
+     * submitted() y compañía leen el índice que endFrame() escribe, así que solo se pueden usar
+     * desde el hilo que graba (o sincronizado con él). El hilo consumidor debe recibir en cambio
+     * el SubmittedFrame que retorna endFrame(), pasado por algo que sincronice (una cola, un
+     * mutex); no toca el estado de la RenderQueue y vale hasta que beginFrame() vuelva a ese
+     * buffer, es decir durante los frames - 1 beginFrame() siguientes.
+     *
+     * Los buffers nunca liberan memoria: clear() es O(1) y conserva la capacidad, así que una
+     * vez que cada buffer alcanzó el tamaño típico de un cuadro no se vuelve a pedir memoria.
+     * allocationCount() cuenta las veces que la cola tuvo que crecer (incluye los buckets).
+     */
+    explicit RenderQueue(std::size_t frames = 1);
+
+    class SubmittedFrame {
+    public:
+        const std::vector<DrawCall>& calls() const;
+        const std::vector<DrawBatch>& batches() const;
+        const std::vector<Instance>& instances() const;
+        const std::byte* payloadData(Payload payload) const;
+
+        template <typename T>
+        T payload(const DrawCall& call) const;
+    private:
+        friend class RenderQueue;
+        explicit SubmittedFrame(const Frame& frame) : m_frame(&frame) {}
+
+        const Frame* m_frame;
+    };
+
+    void beginFrame();
+    SubmittedFrame endFrame();
+    const std::vector<DrawCall>& submitted() const;
+    const std::vector<DrawBatch>& submittedBatches() const;
+    const std::vector<Instance>& submittedInstances() const;
+
+    std::size_t allocationCount() const;
+
+    /* grabación desde varios hilos.
+     *
+     * Cada productor escribe en su propio bucket contiguo a través de un Recorder, sin locks
+     * ni atómicos en enqueue(). beginRecording(n) prepara n buckets y recorder(i) entrega el
+     * i-ésimo; cada hilo debe usar un índice distinto. sort() concatena los buckets en orden
+     * de índice (el resultado no depende del scheduling) y luego ordena. beginRecording(),
+     * recorder() y sort() no deben llamarse mientras haya productores activos.
+     */
+    class Recorder {
+    public:
+        void enqueue(Object obj, Shader shader);
+        void enqueue(Object obj, Shader shader, SortKey key, Instance instance = 0, Payload payload = no_payload);
+
+        Payload allocatePayload(std::size_t size, std::size_t align = alignof(std::max_align_t));
+        std::byte* payloadData(Payload payload);
+
+        template <typename T>
+        void enqueueWithPayload(Object obj, Shader shader, SortKey key, const T& data, Instance instance = 0);
+    private:
+        friend class RenderQueue;
+        explicit Recorder(Bucket& bucket) : m_bucket(&bucket) {}
+
+        Bucket* m_bucket;
+    };
+
+    void beginRecording(std::size_t producers);
+    Recorder recorder(std::size_t producer);
+
     void enqueue(Object obj, Shader shader);
+    void enqueue(Object obj, Shader shader, SortKey key, Instance instance = 0, Payload payload = no_payload);
+
+    /* payloads.
+     *
+     * Cada cuadro tiene su arena (clear() la vacía). allocatePayload() reserva bytes y
+     * payloadData() da acceso a ellos para escribirlos; el offset se pasa a enqueue().
+     * enqueueWithPayload() hace las tres cosas para un T trivialmente copiable, y payload<T>()
+     * lo lee de vuelta. Los payloads grabados con un Recorder se mueven a la arena del cuadro en
+     * sort(), que también corrige los offsets.
+     */
+    Payload allocatePayload(std::size_t size, std::size_t align = alignof(std::max_align_t));
+    std::byte* payloadData(Payload payload);
+    const std::byte* payloadData(Payload payload) const;
+    const std::byte* submittedPayloadData(Payload payload) const;
+
+    template <typename T>
+    void enqueueWithPayload(Object obj, Shader shader, SortKey key, const T& data, Instance instance = 0);
+
+    template <typename T>
+    T payload(const DrawCall& call) const;
 
     const std::vector<DrawCall>& drawCalls() const;
 
+    // batches e instancias del último sort(); quedan obsoletos con el siguiente enqueue().
+    const std::vector<DrawBatch>& batches() const;
+    const std::vector<Instance>& instances() const;
+    BatchStats batchStats() const;
+
     void clear();
 
+    // ordena según DrawCall::key (ver SortMode). También arma los batches.
     void sort();
+
+    void setSortMode(SortMode mode);
 private:
+    struct Frame {
+        std::vector<DrawCall> calls;
+        std::vector<DrawBatch> batches;
+        std::vector<Instance> instances;
+        PayloadArena arena;
+    };
+    std::vector<Frame> m_frames;
+    std::size_t m_recording {0};
+    std::size_t m_submitted;
+
+    std::vector<DrawCall> m_scratch;
+
+    SortMode m_sort_mode {SortMode::Radix};
+
+    // estado del modo incremental: permutación del cuadro anterior y buffers de trabajo.
+    struct KeyIndex {
+        SortKey key;
+        std::uint32_t index;
+    };
+    std::vector<std::uint32_t> m_order;
+    std::vector<KeyIndex> m_keys;
+    std::vector<KeyIndex> m_keys_rest;
+    std::vector<KeyIndex> m_keys_scratch;
+
+    // alineado a una línea de cache para que los productores no compartan líneas (false sharing).
+    struct alignas(64) Bucket {
+        std::vector<DrawCall> calls;
+        PayloadArena arena;
+        std::size_t allocations {0};
+    };
+    std::vector<Bucket> m_buckets;
+
+    std::size_t m_allocations {0};
+
+    Frame& recording();
+    void mergeBuckets();
+    void buildBatches();
+    void incrementalSort();
 };
 
+namespace detail {
+
+template <typename T>
+void checkPayloadType() {
+    static_assert(std::is_trivially_copyable_v<T>, "los payloads se copian byte a byte");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "alineamiento no soportado por la arena");
+}
+
+}
+
+template <typename T>
+void RenderQueue::Recorder::enqueueWithPayload(Object obj, Shader shader, SortKey key, const T& data, Instance instance) {
+    detail::checkPayloadType<T>();
+    const Payload payload = allocatePayload(sizeof(T), alignof(T));
+    std::memcpy(payloadData(payload), &data, sizeof(T));
+    enqueue(obj, shader, key, instance, payload);
+}
+
+template <typename T>
+void RenderQueue::enqueueWithPayload(Object obj, Shader shader, SortKey key, const T& data, Instance instance) {
+    detail::checkPayloadType<T>();
+    const Payload payload = allocatePayload(sizeof(T), alignof(T));
+    std::memcpy(payloadData(payload), &data, sizeof(T));
+    enqueue(obj, shader, key, instance, payload);
+}
+
+template <typename T>
+T RenderQueue::payload(const DrawCall& call) const {
+    detail::checkPayloadType<T>();
+    T data;
+    std::memcpy(&data, payloadData(call.payload), sizeof(T));
+    return data;
+}
+
+template <typename T>
+T RenderQueue::SubmittedFrame::payload(const DrawCall& call) const {
+    detail::checkPayloadType<T>();
+    T data;
+    std::memcpy(&data, payloadData(call.payload), sizeof(T));
+    return data;
+}
+
 #endif//AUX2_COINTAINERS_HPP
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "input_map.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+
+void InputMap::bind(Input input, Action action) {
+    m_pairs.emplace_back(input, action);
+    m_dirty = true;
+}
+
+void InputMap::unbind(Input input, Action action) {
+    m_pairs.erase(std::remove(m_pairs.begin(), m_pairs.end(), std::make_pair(input, action)), m_pairs.end());
+    m_dirty = true;
+}
+
+CallbackId InputMap::addCallback(Action action, InputCallback callback) {
+    const CallbackId id = m_next_id++;
+    if (m_dispatching) {
+        m_added.push_back({action, id, std::move(callback)});
+    } else {
+        m_callbacks.push_back({action, id, std::move(callback)});
+        m_dirty = true;
+    }
+    return id;
+}
+
+bool InputMap::removeCallback(CallbackId id) {
+    auto matches = [id](const Callback& c) { return c.id == id; };
+
+    const auto added = std::find_if(m_added.begin(), m_added.end(), matches);
+    if (added != m_added.end()) {
+        m_added.erase(added);
+        return true;
+    }
+
+    const auto it = std::find_if(m_callbacks.begin(), m_callbacks.end(), matches);
+    if (it == m_callbacks.end() || std::find(m_removed.begin(), m_removed.end(), id) != m_removed.end())
+        return false;
+    if (m_dispatching) {
+        m_removed.push_back(id);
+    } else {
+        m_callbacks.erase(it);
+        m_dirty = true;
+    }
+    return true;
+}
+
+void InputMap::applyPending() {
+    if (m_added.empty() && m_removed.empty())
+        return;
+
+    auto removed = [this](const Callback& c) {
+        return std::find(m_removed.begin(), m_removed.end(), c.id) != m_removed.end();
+    };
+    m_callbacks.erase(std::remove_if(m_callbacks.begin(), m_callbacks.end(), removed), m_callbacks.end());
+    std::move(m_added.begin(), m_added.end(), std::back_inserter(m_callbacks));
+
+    m_added.clear();
+    m_removed.clear();
+    m_dirty = true;
+}
+
+void InputMap::build() {
+    // durante un dispatch() las tablas se están recorriendo: se reconstruyen al terminar.
+    if (!m_dirty || m_dispatching)
+        return;
+
+    std::sort(m_pairs.begin(), m_pairs.end());
+    m_pairs.erase(std::unique(m_pairs.begin(), m_pairs.end()), m_pairs.end());
+
+    std::stable_sort(m_callbacks.begin(), m_callbacks.end(),
+                     [](const Callback& a, const Callback& b) { return a.action < b.action; });
+
+    m_inputs.clear();
+    m_bindings.clear();
+    for (const auto& [input, action] : m_pairs) {
+        const Action a = action;
+        const auto first = std::partition_point(m_callbacks.begin(), m_callbacks.end(),
+                                                [a](const Callback& c) { return c.action < a; });
+        const auto last = std::partition_point(first, m_callbacks.end(),
+                                               [a](const Callback& c) { return c.action == a; });
+        m_inputs.push_back(input);
+        m_bindings.push_back({action,
+                              std::uint32_t(first - m_callbacks.begin()),
+                              std::uint32_t(last - m_callbacks.begin())});
+    }
+
+    m_dirty = false;
+}
+
+std::size_t InputMap::dispatchOne(Input input) {
+    const auto first = std::lower_bound(m_inputs.begin(), m_inputs.end(), input);
+
+    std::size_t invoked = 0;
+    for (auto i = std::size_t(first - m_inputs.begin()); i < m_inputs.size() && m_inputs[i] == input; ++i) {
+        const Binding& binding = m_bindings[i];
+        for (auto c = binding.first_callback; c < binding.last_callback; ++c)
+            m_callbacks[c].function(input, binding.action);
+        invoked += binding.last_callback - binding.first_callback;
+    }
+    return invoked;
+}
+
+std::size_t InputMap::dispatch(Input input) {
+    return dispatch(&input, 1);
+}
+
+std::size_t InputMap::dispatch(const Input* inputs, std::size_t count) {
+    build();
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // si un callback lanza, el contador igual vuelve atrás y los cambios pendientes se aplican.
+    struct Dispatching {
+        InputMap& map;
+        explicit Dispatching(InputMap& map) : map(map) { ++map.m_dispatching; }
+        ~Dispatching() {
+            if (--map.m_dispatching == 0)
+                map.applyPending();
+        }
+    };
+
+    std::size_t invoked = 0;
+    {
+        Dispatching dispatching {*this};
+        for (std::size_t i = 0; i < count; ++i)
+            invoked += dispatchOne(inputs[i]);
+    }
+
+    m_stats.time += std::chrono::steady_clock::now() - start;
+    m_stats.events += count;
+    m_stats.callbacks += invoked;
+    return invoked;
+}
+
+std::vector<Action> InputMap::actions(Input input) {
+    build();
+
+    std::vector<Action> result;
+    const auto range = std::equal_range(m_inputs.begin(), m_inputs.end(), input);
+    for (auto it = range.first; it != range.second; ++it)
+        result.push_back(m_bindings[it - m_inputs.begin()].action);
+    return result;
+}
+
+const DispatchStats& InputMap::stats() const {
+    return m_stats;
+}
+
+void InputMap::resetStats() {
+    m_stats = {};
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#ifndef AUX2_INPUT_MAP_HPP
+#define AUX2_INPUT_MAP_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+
+/* mapa de inputs a acciones y callbacks.
+ *
+ * Cubre lo mismo que set (varios inputs para una acción), map (callbacks por input) y multimap
+ * (varios callbacks para un mismo input), pero guardado en arreglos planos ordenados en lugar
+ * de árboles: despachar un input es una búsqueda binaria sobre un arreglo contiguo de enteros
+ * y luego recorrer rangos contiguos, sin saltar entre nodos del heap.
+ *
+ * bind()/unbind()/addCallback()/removeCallback() solo marcan las tablas como desactualizadas;
+ * se reconstruyen (O(n log n)) en el siguiente dispatch(). La idea es que los bindings cambien
+ * poco y se despachen muchas veces por cuadro.
+ *
+ * Un callback puede llamar a cualquiera de ellas (y a dispatch()) mientras se despacha: los
+ * callbacks agregados o quitados quedan pendientes y se aplican cuando termina el dispatch()
+ * más externo, y las tablas no se reconstruyen hasta entonces.
+ *
+ * stats() acumula el costo de despachar: eventos, callbacks invocados y tiempo total.
+ */
+
+using Input = int;
+using Action = int;
+using InputCallback = std::function<void(Input input, Action action)>;
+using CallbackId = std::uint32_t;
+
+struct DispatchStats {
+    std::size_t events {0};
+    std::size_t callbacks {0};
+    std::chrono::nanoseconds time {0};
+
+    double nanosecondsPerEvent() const {
+        return events ? double(time.count()) / double(events) : 0.0;
+    }
+};
+
+class InputMap {
+public:
+    void bind(Input input, Action action);
+    void unbind(Input input, Action action);
+
+    // los callbacks de una misma acción se invocan en el orden en que se agregaron.
+    CallbackId addCallback(Action action, InputCallback callback);
+    // retorna false si el id no corresponde a ningún callback.
+    bool removeCallback(CallbackId id);
+
+    // invoca los callbacks de todas las acciones asociadas a cada input; retorna cuántos invocó.
+    std::size_t dispatch(Input input);
+    std::size_t dispatch(const Input* inputs, std::size_t count);
+
+    std::vector<Action> actions(Input input);
+
+    // reconstruye las tablas si hubo cambios (dispatch() y actions() lo llaman solas).
+    void build();
+
+    const DispatchStats& stats() const;
+    void resetStats();
+
+private:
+    struct Binding {
+        Action action;
+        std::uint32_t first_callback;
+        std::uint32_t last_callback;
+    };
+
+    struct Callback {
+        Action action;
+        CallbackId id;
+        InputCallback function;
+    };
+
+    // pares (input, acción) y callbacks por acción; build() los ordena en el lugar.
+    std::vector<std::pair<Input, Action>> m_pairs;
+    std::vector<Callback> m_callbacks;
+    bool m_dirty {false};
+    CallbackId m_next_id {0};
+
+    // cambios a m_callbacks pedidos durante un dispatch(), que no puede mover el arreglo que
+    // está recorriendo.
+    int m_dispatching {0};
+    std::vector<Callback> m_added;
+    std::vector<CallbackId> m_removed;
+
+    // m_inputs[i] es el input de m_bindings[i], ambos ordenados por input. Cada binding guarda
+    // el rango de sus callbacks en m_callbacks, así dispatch() hace una sola búsqueda.
+    std::vector<Input> m_inputs;
+    std::vector<Binding> m_bindings;
+
+    DispatchStats m_stats;
+
+    std::size_t dispatchOne(Input input);
+    void applyPending();
+};
+
+#endif//AUX2_INPUT_MAP_HPP
@@ -0,0 +1,206 @@
+#ifndef AUX2_RING_BUFFER_HPP
+#define AUX2_RING_BUFFER_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+
+/* colas acotadas sin locks.
+ *
+ * Alternativa a un std::deque protegido por un mutex para pasar eventos entre hilos: la memoria
+ * se reserva una sola vez en el constructor (la capacidad se redondea a una potencia de 2) y
+ * push/pop solo usan atómicos. Los índices de lectura y escritura viven en líneas de cache
+ * distintas para que productores y consumidores no se invaliden la cache mutuamente.
+ *
+ * tryPush()/tryPop() no bloquean: retornan false (o la cantidad transferida, en las versiones
+ * por lote) si la cola está llena o vacía. Las versiones por lote pagan la sincronización una
+ * vez por lote en lugar de una vez por elemento.
+ *
+ * T debe ser trivialmente copiable (eventos, ids, structs simples).
+ */
+
+constexpr std::size_t cache_line_size = 64;
+
+namespace detail {
+
+inline std::size_t roundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n)
+        p <<= 1;
+    return p;
+}
+
+}
+
+/* SpscRingBuffer
+ *
+ * Un productor y un consumidor. Cada lado guarda una copia del índice del otro y solo la
+ * actualiza cuando la cola parece llena/vacía, así que en régimen normal un push o pop no lee
+ * ninguna línea de cache escrita por el otro hilo.
+ */
+template <typename T>
+class SpscRingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    explicit SpscRingBuffer(std::size_t capacity) :
+    m_slots(detail::roundUpPow2(std::max<std::size_t>(capacity, 2))),
+    m_mask(m_slots.size() - 1)
+    {}
+
+    std::size_t capacity() const {
+        return m_slots.size();
+    }
+
+    bool tryPush(const T& item) {
+        return tryPush(&item, 1) == 1;
+    }
+
+    bool tryPop(T& item) {
+        return tryPop(&item, 1) == 1;
+    }
+
+    std::size_t tryPush(const T* items, std::size_t count) {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+        std::size_t free = capacity() - (tail - m_head_cache);
+        if (free < count) {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            free = capacity() - (tail - m_head_cache);
+        }
+
+        const std::size_t n = std::min(count, free);
+        for (std::size_t i = 0; i < n; ++i)
+            m_slots[(tail + i) & m_mask] = items[i];
+
+        m_tail.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    std::size_t tryPop(T* items, std::size_t count) {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+        std::size_t available = m_tail_cache - head;
+        if (available < count) {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            available = m_tail_cache - head;
+        }
+
+        const std::size_t n = std::min(count, available);
+        for (std::size_t i = 0; i < n; ++i)
+            items[i] = m_slots[(head + i) & m_mask];
+
+        m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+private:
+    std::vector<T> m_slots;
+    std::size_t m_mask;
+
+    // lado del productor
+    alignas(cache_line_size) std::atomic<std::size_t> m_tail {0};
+    std::size_t m_head_cache {0};
+
+    // lado del consumidor
+    alignas(cache_line_size) std::atomic<std::size_t> m_head {0};
+    std::size_t m_tail_cache {0};
+};
+
+/* MpmcRingBuffer
+ *
+ * Varios productores y varios consumidores (cola acotada de D. Vyukov). Cada celda lleva un
+ * número de secuencia que indica si está libre para la posición que la reclama o si ya tiene
+ * un dato publicado; los hilos se reparten posiciones con un compare-exchange sobre head/tail.
+ * Las versiones por lote reclaman un rango de celdas consecutivas con un solo compare-exchange.
+ */
+template <typename T>
+class MpmcRingBuffer {
+    static_assert(std::is_trivially_copyable_v<T>);
+public:
+    explicit MpmcRingBuffer(std::size_t capacity) :
+    m_cells(detail::roundUpPow2(std::max<std::size_t>(capacity, 2))),
+    m_mask(m_cells.size() - 1)
+    {
+        for (std::size_t i = 0; i < m_cells.size(); ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const {
+        return m_cells.size();
+    }
+
+    bool tryPush(const T& item) {
+        return tryPush(&item, 1) == 1;
+    }
+
+    bool tryPop(T& item) {
+        return tryPop(&item, 1) == 1;
+    }
+
+    std::size_t tryPush(const T* items, std::size_t count) {
+        std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        std::size_t n;
+        do {
+            // celdas consecutivas libres para las posiciones tail, tail + 1, ...
+            n = 0;
+            while (n < count && m_cells[(tail + n) & m_mask].sequence.load(std::memory_order_acquire) == tail + n)
+                ++n;
+            if (n == 0) {
+                const std::size_t current = m_tail.load(std::memory_order_relaxed);
+                if (current == tail)
+                    return 0;   // llena
+                tail = current;
+                continue;
+            }
+        } while (n == 0 || !m_tail.compare_exchange_weak(tail, tail + n, std::memory_order_relaxed));
+
+        for (std::size_t i = 0; i < n; ++i) {
+            Cell& cell = m_cells[(tail + i) & m_mask];
+            cell.value = items[i];
+            cell.sequence.store(tail + i + 1, std::memory_order_release);
+        }
+        return n;
+    }
+
+    std::size_t tryPop(T* items, std::size_t count) {
+        std::size_t head = m_head.load(std::memory_order_relaxed);
+        std::size_t n;
+        do {
+            // celdas consecutivas ya publicadas para las posiciones head, head + 1, ...
+            n = 0;
+            while (n < count && m_cells[(head + n) & m_mask].sequence.load(std::memory_order_acquire) == head + n + 1)
+                ++n;
+            if (n == 0) {
+                const std::size_t current = m_head.load(std::memory_order_relaxed);
+                if (current == head)
+                    return 0;   // vacía
+                head = current;
+                continue;
+            }
+        } while (n == 0 || !m_head.compare_exchange_weak(head, head + n, std::memory_order_relaxed));
+
+        for (std::size_t i = 0; i < n; ++i) {
+            Cell& cell = m_cells[(head + i) & m_mask];
+            items[i] = cell.value;
+            cell.sequence.store(head + i + capacity(), std::memory_order_release);
+        }
+        return n;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::vector<Cell> m_cells;
+    std::size_t m_mask;
+
+    alignas(cache_line_size) std::atomic<std::size_t> m_tail {0};
+    alignas(cache_line_size) std::atomic<std::size_t> m_head {0};
+};
+
+#endif//AUX2_RING_BUFFER_HPP
\ No newline at end of file
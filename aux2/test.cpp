@@ -2,6 +2,19 @@
 #include "catch.hpp"
 
 #include "containers.hpp"
+#include "ring_buffer.hpp"
+#include "input_map.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
 
 TEST_CASE("Invertir") {
     std::list<int> list_a {1, 5, 3, 8};
@@ -48,4 +61,525 @@ TEST_CASE("RenderQueue") {
 
     queue.clear();
     REQUIRE(queue.drawCalls().size() == 0);
+
+    // sin llave explícita se ordena por el int completo del shader: 0 y 65536 no se confunden
+    // y los negativos van primero.
+    queue.enqueue(circle, 65536);
+    queue.enqueue(square, 0);
+    queue.enqueue(triangle, -1);
+    queue.enqueue(circle, 0);
+    queue.enqueue(square, 65536);
+    queue.sort();
+
+    std::vector<Shader> shaders;
+    for (const auto& call : queue.drawCalls())
+        shaders.push_back(call.shader);
+    REQUIRE(shaders == std::vector<Shader> {-1, 0, 0, 65536, 65536});
+    REQUIRE(queue.drawCalls()[1].object == circle);
+    REQUIRE(queue.batches().size() == 5);
+}
+
+TEST_CASE("RenderQueue sort keys") {
+
+    RenderQueue queue;
+
+    queue.enqueue(1, 2, makeSortKey(0, true, 2, 1, 0.25f));
+    queue.enqueue(1, 2, makeSortKey(0, true, 2, 1, 0.75f));
+    queue.enqueue(2, 1, makeSortKey(1, false, 1, 2, 0.5f));
+    queue.enqueue(3, 2, makeSortKey(0, false, 2, 3, 0.5f));
+    queue.enqueue(3, 1, makeSortKey(0, false, 1, 3, 0.9f));
+    queue.enqueue(3, 1, makeSortKey(0, false, 1, 3, 0.1f));
+
+    queue.sort();
+
+    const auto& calls = queue.drawCalls();
+    REQUIRE(calls.size() == 6);
+
+    for (std::size_t i = 1; i < calls.size(); ++i)
+        REQUIRE(calls[i - 1].key <= calls[i].key);
+
+    // opacos por programa y de adelante hacia atrás, luego translúcidos de atrás hacia adelante.
+    REQUIRE(calls[0].key == makeSortKey(0, false, 1, 3, 0.1f));
+    REQUIRE(calls[1].key == makeSortKey(0, false, 1, 3, 0.9f));
+    REQUIRE(calls[2].shader == 2);
+    REQUIRE(calls[3].key == makeSortKey(0, true, 2, 1, 0.75f));
+    REQUIRE(calls[4].key == makeSortKey(0, true, 2, 1, 0.25f));
+    REQUIRE(calls[5].object == 2);
+
+    // la profundidad fuera de [0, 1] se satura; NaN cuenta como 0.
+    REQUIRE(makeSortKey(0, false, 1, 3, std::numeric_limits<float>::quiet_NaN()) == makeSortKey(0, false, 1, 3, 0.0f));
+    REQUIRE(makeSortKey(0, true, 1, 3, std::numeric_limits<float>::quiet_NaN()) == makeSortKey(0, true, 1, 3, 0.0f));
+    REQUIRE(makeSortKey(0, false, 1, 3, -2.0f) == makeSortKey(0, false, 1, 3, 0.0f));
+    REQUIRE(makeSortKey(0, false, 1, 3, 7.0f) == makeSortKey(0, false, 1, 3, 1.0f));
+}
+
+TEST_CASE("RenderQueue multi-producer recording") {
+
+    constexpr int producers = 12;
+    constexpr int calls_per_producer = 20000;
+
+    RenderQueue queue;
+    queue.enqueue(-1, 0);
+
+    // dos cuadros seguidos: el segundo reutiliza los buckets del primero.
+    for (int frame = 0; frame < 2; ++frame) {
+        queue.beginRecording(producers);
+
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([recorder = queue.recorder(p), p]() mutable {
+                for (int i = 0; i < calls_per_producer; ++i) {
+                    Object object = p * calls_per_producer + i;
+                    Shader shader = (i * 7 + p) % 5;
+                    recorder.enqueue(object, shader, makeSortKey(0, false, shader, object % 1000, 0.0f));
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        queue.sort();
+
+        const auto& calls = queue.drawCalls();
+        const std::size_t expected = producers * calls_per_producer + (frame == 0 ? 1 : 0);
+        REQUIRE(calls.size() == expected);
+
+        REQUIRE(std::is_sorted(calls.begin(), calls.end(),
+                               [](const DrawCall& a, const DrawCall& b) { return a.key < b.key; }));
+
+        std::vector<bool> seen(producers * calls_per_producer, false);
+        for (const auto& call : calls)
+            if (call.object >= 0)
+                seen[call.object] = true;
+        REQUIRE(std::count(seen.begin(), seen.end(), true) == producers * calls_per_producer);
+
+        queue.clear();
+        REQUIRE(queue.drawCalls().empty());
+    }
+}
+
+TEST_CASE("RenderQueue frame pipelining") {
+
+    RenderQueue queue {2};
+
+    auto record = [&queue](int frame) {
+        queue.beginFrame();
+        for (int i = 0; i < 1000; ++i)
+            queue.enqueue(frame, (i * 31) % 17);
+        queue.endFrame();
+    };
+
+    record(0);
+    REQUIRE(queue.submitted().size() == 1000);
+    REQUIRE(queue.allocationCount() > 0);
+
+    // mientras se graba el cuadro 1, el cuadro 0 sigue disponible para submit.
+    queue.beginFrame();
+    queue.enqueue(1, 0);
+    REQUIRE(queue.drawCalls().size() == 1);
+    REQUIRE(queue.submitted().size() == 1000);
+    REQUIRE(queue.submitted().front().object == 0);
+    queue.endFrame();
+    REQUIRE(queue.submitted().size() == 1);
+
+    // una vez que ambos buffers alcanzaron su tamaño, los cuadros no piden memoria.
+    for (int frame = 2; frame < 6; ++frame)
+        record(frame);
+    const auto allocations = queue.allocationCount();
+    for (int frame = 6; frame < 100; ++frame)
+        record(frame);
+    REQUIRE(queue.allocationCount() == allocations);
+    REQUIRE(queue.submitted().size() == 1000);
+    REQUIRE(queue.submitted().front().object == 99);
+
+    // otro hilo consume cada cuadro a través del SubmittedFrame, mientras se graba el siguiente.
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::optional<RenderQueue::SubmittedFrame> handoff;
+    constexpr int frames = 50;
+    // las aserciones de Catch no son thread-safe: el consumidor anota y se verifica al final.
+    std::vector<char> complete(frames, 0);
+
+    std::thread consumer([&]() {
+        for (int frame = 0; frame < frames; ++frame) {
+            std::unique_lock<std::mutex> lock {mutex};
+            changed.wait(lock, [&handoff]() { return handoff.has_value(); });
+            const auto submitted = *handoff;
+            lock.unlock();
+
+            const auto& calls = submitted.calls();
+            complete[frame] = calls.size() == 1000 && !submitted.batches().empty()
+                && std::all_of(calls.begin(), calls.end(), [frame](const DrawCall& c) { return c.object == frame; });
+
+            lock.lock();
+            handoff.reset();
+            changed.notify_all();
+        }
+    });
+    for (int frame = 0; frame < frames; ++frame) {
+        queue.beginFrame();
+        for (int i = 0; i < 1000; ++i)
+            queue.enqueue(frame, (i * 31) % 17);
+        const auto submitted = queue.endFrame();
+
+        // el beginFrame() siguiente reusa el buffer del cuadro anterior: hay que esperar a que
+        // el consumidor lo suelte.
+        std::unique_lock<std::mutex> lock {mutex};
+        changed.wait(lock, [&handoff]() { return !handoff.has_value(); });
+        handoff = submitted;
+        changed.notify_all();
+    }
+    consumer.join();
+    REQUIRE(std::count(complete.begin(), complete.end(), 1) == frames);
+}
+
+TEST_CASE("RenderQueue batches") {
+
+    RenderQueue queue;
+
+    Object cube {1};
+    Object sphere {2};
+
+    Shader lit {1};
+    Shader unlit {2};
+
+    for (Instance i = 0; i < 5; ++i)
+        queue.enqueue(cube, lit, makeSortKey(0, false, lit, cube, 0.0f), i);
+    for (Instance i = 5; i < 8; ++i)
+        queue.enqueue(sphere, lit, makeSortKey(0, false, lit, sphere, 0.0f), i);
+    queue.enqueue(cube, unlit, makeSortKey(0, false, unlit, cube, 0.0f), 8);
+    queue.enqueue(cube, lit, makeSortKey(0, false, lit, cube, 0.0f), 9);
+
+    queue.sort();
+
+    const auto& batches = queue.batches();
+    REQUIRE(batches.size() == 3);
+
+    REQUIRE(batches[0].object == cube);
+    REQUIRE(batches[0].shader == lit);
+    REQUIRE(batches[0].count == 6);
+    REQUIRE(batches[1].object == sphere);
+    REQUIRE(batches[1].count == 3);
+    REQUIRE(batches[2].shader == unlit);
+    REQUIRE(batches[2].first == 9);
+    REQUIRE(batches[2].count == 1);
+
+    // el rango de cada batch apunta a sus instancias, en el orden en que se encolaron.
+    const auto& instances = queue.instances();
+    REQUIRE(instances.size() == 10);
+    REQUIRE(std::vector<Instance>(instances.begin(), instances.begin() + 6) == std::vector<Instance> {0, 1, 2, 3, 4, 9});
+    REQUIRE(instances[batches[2].first] == 8);
+
+    auto stats = queue.batchStats();
+    REQUIRE(stats.batches == 3);
+    REQUIRE(stats.average_size == Approx(10.0 / 3.0));
+
+    queue.clear();
+    REQUIRE(queue.batches().empty());
+    REQUIRE(queue.batchStats().batches == 0);
+}
+
+TEST_CASE("RenderQueue incremental sort") {
+
+    std::mt19937 rng {42};
+    std::uniform_int_distribution<int> id {0, 63};
+
+    std::vector<DrawCall> frame(5000);
+    for (auto& call : frame) {
+        call.object = id(rng);
+        call.shader = id(rng);
+    }
+
+    RenderQueue incremental;
+    incremental.setSortMode(SortMode::Incremental);
+    RenderQueue radix;
+
+    auto byKey = [](const DrawCall& a, const DrawCall& b) { return a.key < b.key; };
+
+    for (int f = 0; f < 8; ++f) {
+        // cuadros coherentes: cambia un 5% de las llaves, y algunos cuadros crecen o se achican.
+        for (int i = 0; i < 250; ++i)
+            frame[rng() % frame.size()].shader = id(rng);
+        if (f == 3) {
+            DrawCall added {};
+            added.object = 7;
+            added.shader = 7;
+            frame.resize(5500, added);
+        }
+        if (f == 5)
+            frame.resize(4000);
+        // un cuadro sin ninguna relación con el anterior.
+        if (f == 6)
+            std::shuffle(frame.begin(), frame.end(), rng);
+
+        incremental.clear();
+        radix.clear();
+        for (const auto& call : frame) {
+            auto key = makeSortKey(0, false, call.shader, call.object, 0.0f);
+            incremental.enqueue(call.object, call.shader, key);
+            radix.enqueue(call.object, call.shader, key);
+        }
+        incremental.sort();
+        radix.sort();
+
+        const auto& a = incremental.drawCalls();
+        const auto& b = radix.drawCalls();
+        REQUIRE(a.size() == frame.size());
+        REQUIRE(std::is_sorted(a.begin(), a.end(), byKey));
+        REQUIRE(std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                           [](const DrawCall& x, const DrawCall& y) { return x.key == y.key; }));
+    }
+}
+
+TEST_CASE("SpscRingBuffer") {
+
+    SpscRingBuffer<int> ring {100};
+    REQUIRE(ring.capacity() == 128);
+
+    int value;
+    REQUIRE_FALSE(ring.tryPop(value));
+
+    constexpr int count = 200000;
+
+    // el productor escribe en lotes de tamaño variable, el consumidor lee de a uno o en lotes.
+    std::thread producer([&ring]() {
+        int next = 0;
+        int batch[7];
+        while (next < count) {
+            const int n = std::min(1 + next % 7, count - next);
+            std::iota(batch, batch + n, next);
+            int pushed = 0;
+            while (pushed < n) {
+                pushed += int(ring.tryPush(batch + pushed, n - pushed));
+                std::this_thread::yield();
+            }
+            next += n;
+        }
+    });
+
+    int expected = 0;
+    bool in_order = true;
+    int batch[5];
+    while (expected < count) {
+        std::size_t n = expected % 2 ? ring.tryPop(batch, 5) : ring.tryPop(batch[0]);
+        for (std::size_t i = 0; i < n; ++i)
+            in_order = in_order && batch[i] == expected++;
+        if (n == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    REQUIRE(in_order);
+    REQUIRE_FALSE(ring.tryPop(value));
+}
+
+TEST_CASE("MpmcRingBuffer") {
+
+    MpmcRingBuffer<int> ring {64};
+
+    int values[100];
+    std::iota(values, values + 100, 0);
+    REQUIRE(ring.tryPush(values, 100) == 64);
+    REQUIRE_FALSE(ring.tryPush(values[0]));
+    REQUIRE(ring.tryPop(values, 100) == 64);
+    REQUIRE(values[63] == 63);
+
+    constexpr int producers = 4;
+    constexpr int consumers = 4;
+    constexpr int per_producer = 50000;
+
+    std::atomic<long long> sum {0};
+    std::atomic<int> popped {0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p]() {
+            for (int i = 0; i < per_producer; i += 4) {
+                int batch[4] {p, p, p, i};
+                int pushed = 0;
+                while (pushed < 4) {
+                    pushed += int(ring.tryPush(batch + pushed, 4 - pushed));
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&ring, &sum, &popped]() {
+            int batch[3];
+            while (popped.load() < producers * per_producer) {
+                const auto n = ring.tryPop(batch, 3);
+                for (std::size_t i = 0; i < n; ++i)
+                    sum += batch[i];
+                popped += int(n);
+                if (n == 0)
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    long long expected = 0;
+    for (int p = 0; p < producers; ++p)
+        for (int i = 0; i < per_producer; i += 4)
+            expected += 3 * p + i;
+
+    REQUIRE(popped == producers * per_producer);
+    REQUIRE(sum == expected);
+}
+
+TEST_CASE("InputMap") {
+
+    constexpr Input key_w {87};
+    constexpr Input key_up {265};
+    constexpr Input key_space {32};
+
+    constexpr Action forward {1};
+    constexpr Action jump {2};
+
+    InputMap map;
+    std::vector<std::pair<Input, int>> log;
+
+    // varios inputs para una acción, y varios callbacks para una misma acción.
+    map.bind(key_w, forward);
+    map.bind(key_up, forward);
+    map.bind(key_space, jump);
+    map.bind(key_space, jump);
+    map.addCallback(forward, [&log](Input input, Action) { log.emplace_back(input, 1); });
+    map.addCallback(jump, [&log](Input input, Action) { log.emplace_back(input, 2); });
+    map.addCallback(forward, [&log](Input input, Action) { log.emplace_back(input, 3); });
+
+    REQUIRE(map.dispatch(key_up) == 2);
+    REQUIRE(log == std::vector<std::pair<Input, int>> {{key_up, 1}, {key_up, 3}});
+
+    // un input con dos acciones dispara los callbacks de ambas.
+    map.bind(key_space, forward);
+    REQUIRE(map.actions(key_space) == std::vector<Action> {forward, jump});
+
+    log.clear();
+    Input events[] {key_space, 0, key_w};
+    REQUIRE(map.dispatch(events, 3) == 5);
+    REQUIRE(log.size() == 5);
+    REQUIRE(log.back() == std::pair<Input, int> {key_w, 3});
+
+    map.unbind(key_space, forward);
+    REQUIRE(map.actions(key_space) == std::vector<Action> {jump});
+    REQUIRE(map.dispatch(key_space) == 1);
+
+    REQUIRE(map.stats().events == 5);
+    REQUIRE(map.stats().callbacks == 8);
+    map.resetStats();
+    REQUIRE(map.stats().events == 0);
+
+    SECTION("callbacks agregados y quitados") {
+        InputMap input;
+        input.bind(key_space, jump);
+        std::vector<int> calls;
+
+        const CallbackId first = input.addCallback(jump, [&calls](Input, Action) { calls.push_back(1); });
+        const CallbackId second = input.addCallback(jump, [&calls](Input, Action) { calls.push_back(2); });
+        REQUIRE(first != second);
+        REQUIRE(input.removeCallback(first));
+        REQUIRE_FALSE(input.removeCallback(first));
+        REQUIRE(input.dispatch(key_space) == 1);
+        REQUIRE(calls == std::vector<int> {2});
+
+        // durante el dispatch: lo que se agrega y se quita vale desde el dispatch siguiente,
+        // aunque agregar reubique los callbacks (y un dispatch anidado no reconstruya nada).
+        CallbackId added {};
+        bool once = true;
+        input.addCallback(jump, [&](Input, Action) {
+            if (!once)
+                return;
+            once = false;
+            for (int i = 0; i < 100; ++i)
+                added = input.addCallback(jump, [&calls](Input, Action) { calls.push_back(3); });
+            REQUIRE(input.removeCallback(second));
+            REQUIRE(input.removeCallback(added));
+            input.dispatch(key_space);
+        });
+
+        calls.clear();
+        REQUIRE(input.dispatch(key_space) == 2);     // el anidado cuenta aparte
+        REQUIRE(calls == std::vector<int> {2, 2});
+        calls.clear();
+        REQUIRE(input.dispatch(key_space) == 100);
+        REQUIRE(calls == std::vector<int>(99, 3));
+    }
+}
+
+TEST_CASE("RenderQueue payloads") {
+
+    struct Material {
+        float model[16];
+        float color[4];
+        int texture;
+    };
+
+    RenderQueue queue {2};
+
+    auto record = [&queue](int frame) {
+        queue.beginFrame();
+        for (int i = 0; i < 100; ++i) {
+            Material material {};
+            material.model[15] = float(i);
+            material.color[0] = float(frame);
+            material.texture = i;
+            Shader shader = i % 3;
+            queue.enqueueWithPayload(i, shader, makeSortKey(0, false, shader, i, 0.0f), material);
+        }
+
+        // payload de tamaño variable escrito directamente en la arena.
+        const Payload text = queue.allocatePayload(6, 1);
+        std::memcpy(queue.payloadData(text), "hello", 6);
+        queue.enqueue(-1, 9, makeSortKey(1, false, 9, 0, 0.0f), 0, text);
+
+        queue.endFrame();
+    };
+
+    record(0);
+
+    const auto& calls = queue.submitted();
+    REQUIRE(calls.size() == 101);
+    for (const auto& call : calls) {
+        if (call.object < 0) {
+            REQUIRE(std::strcmp(reinterpret_cast<const char*>(queue.submittedPayloadData(call.payload)), "hello") == 0);
+            continue;
+        }
+        Material material;
+        std::memcpy(&material, queue.submittedPayloadData(call.payload), sizeof(Material));
+        REQUIRE(material.texture == call.object);
+        REQUIRE(material.model[15] == float(call.object));
+    }
+
+    // la arena se vacía con el cuadro y no vuelve a pedir memoria.
+    for (int frame = 1; frame < 4; ++frame)
+        record(frame);
+    const auto allocations = queue.allocationCount();
+    for (int frame = 4; frame < 20; ++frame)
+        record(frame);
+    REQUIRE(queue.allocationCount() == allocations);
+
+    // payloads grabados desde varios hilos quedan en la arena del cuadro tras sort().
+    queue.beginFrame();
+    queue.beginRecording(4);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < 4; ++p) {
+        threads.emplace_back([recorder = queue.recorder(p), p]() mutable {
+            for (int i = 0; i < 1000; ++i) {
+                Object object = p * 1000 + i;
+                recorder.enqueueWithPayload(object, p, makeSortKey(0, false, p, i, 0.0f), double(object));
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+    queue.sort();
+
+    REQUIRE(queue.drawCalls().size() == 4000);
+    bool payloads_match = true;
+    for (const auto& call : queue.drawCalls())
+        payloads_match = payloads_match && queue.payload<double>(call) == double(call.object);
+    REQUIRE(payloads_match);
 }
\ No newline at end of file
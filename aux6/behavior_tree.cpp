@@ -55,8 +55,10 @@ public:
     BTMove(glm::vec3 v) : velocity(v) {}
 
     Status tick(Scene &scene, entt::entity entity, float delta, GLFWwindow *window) override {
-        auto& tr = scene.registry.get<CTransform>(entity);
-        tr.position += velocity * delta;
+        // patch() avisa a la jerarquía que esta transformación cambió.
+        scene.registry.patch<CTransform>(entity, [this, delta](CTransform& tr) {
+            tr.position += velocity * delta;
+        });
 
         return Status::Success;
     }
@@ -67,6 +69,10 @@ public:
 class BTCheckInput : public BTNode {
 public:
     Status tick(Scene &scene, entt::entity entity, float delta, GLFWwindow *window) override {
+        // sin ventana (modo headless) no hay input
+        if (!window)
+            return Status::Failure;
+
         glm::ivec2 input (
                 glfwGetKey(window, GLFW_KEY_D) - glfwGetKey(window, GLFW_KEY_A),
                 glfwGetKey(window, GLFW_KEY_W) - glfwGetKey(window, GLFW_KEY_S)
@@ -137,12 +143,13 @@ struct CBehaviorTree {
 };
 
 void init(GLFWwindow* window, Scene& scene) {
-    auto shader_program = std::make_shared<RProgram>(makeProgram("vert.glsl", "frag.glsl"));
-    auto mesh = std::make_shared<RMesh>(createCubeMesh());
+    auto shader_program = std::make_shared<RProgram>(makeProgramAsync("vert.glsl", "frag.glsl"),
+                                                     makeProgramAsync("vert_instanced.glsl", "frag_instanced.glsl"));
+    auto mesh = std::make_shared<RMesh>(createCubeMesh(scene.geometry));
 
     auto spawnCube = [&scene, &shader_program, &mesh] (const glm::vec3 &color) {
         auto e = scene.registry.create();
-        scene.root.children.emplace_front(e);
+        scene.hierarchy.add(e, scene.player);
         scene.registry.emplace<CVisual>(e, glm::vec4(color, 1.0f), mesh, shader_program);
         scene.registry.emplace<CTransform>(e);
         return e;
@@ -0,0 +1,260 @@
+#define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_ENABLE_BENCHMARKING
+#include "catch.hpp"
+
+#include "culling.hpp"
+#include "hierarchy.hpp"
+#include "mesh_file.hpp"
+#include "obj_loader.hpp"
+#include "transform.hpp"
+#include "vertex_format.hpp"
+#include "worker_pool.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/* escenas de prueba con n nodos, todos con CTransform:
+ *   ancha: una raíz con n - 1 hijos.
+ *   profunda: una raíz de la que cuelgan cadenas de 1000 nodos (cada uno hijo del anterior).
+ */
+void buildScene(entt::registry& registry, TransformHierarchy& hierarchy, std::size_t n, bool deep) {
+    constexpr std::size_t chain_length = 1000;
+
+    const auto root = registry.create();
+    registry.emplace<CTransform>(root);
+    hierarchy.add(root);
+
+    entt::entity parent = root;
+    for (std::size_t i = 1; i < n; ++i) {
+        const auto entity = registry.create();
+        auto& transform = registry.emplace<CTransform>(entity);
+        transform.position = {0.01f * float(i % 100), 0.5f, 0.0f};
+        transform.rotation = {0.1f, 0.002f * float(i % 1000), 0.0f};
+
+        if (deep && (i - 1) % chain_length == 0)
+            parent = root;
+        hierarchy.add(entity, parent);
+        if (deep)
+            parent = entity;
+    }
+}
+
+// esfera uv de (rings + 1) * (segments + 1) vértices
+ObjMesh uvSphere(int rings, int segments) {
+    ObjMesh mesh;
+    for (int i = 0; i <= rings; ++i) {
+        const float theta = glm::pi<float>() * float(i) / float(rings);
+        for (int j = 0; j <= segments; ++j) {
+            const float phi = 2.0f * glm::pi<float>() * float(j) / float(segments);
+            const glm::vec3 p {std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+            mesh.vertices.push_back({p, p, {float(j) / float(segments), float(i) / float(rings)}});
+        }
+    }
+    for (int i = 0; i < rings; ++i) {
+        for (int j = 0; j < segments; ++j) {
+            const auto a = std::uint32_t(i * (segments + 1) + j);
+            const auto b = a + std::uint32_t(segments + 1);
+            mesh.indices.insert(mesh.indices.end(), {a, a + 1, b + 1, a, b + 1, b});
+        }
+    }
+    return mesh;
+}
+
+}
+
+TEST_CASE("TransformHierarchy::update", "[hierarchy]") {
+    WorkerPool pool;
+    std::cout << "WorkerPool: " << pool.size() << " hilos\n";
+
+    for (std::size_t n : {10'000, 100'000, 1'000'000}) {
+        for (bool deep : {false, true}) {
+            entt::registry registry;
+            TransformHierarchy hierarchy;
+            buildScene(registry, hierarchy, n, deep);
+            hierarchy.update(registry);
+
+            const std::string name = (deep ? "deep " : "wide ") + std::to_string(n);
+            const entt::entity root = hierarchy.entities().front();
+
+            // marcar la raíz fuerza a recalcular la jerarquía completa.
+            BENCHMARK("serial " + name) {
+                hierarchy.markDirty(root);
+                hierarchy.update(registry);
+                return hierarchy.recomputed();
+            };
+
+            BENCHMARK("parallel " + name) {
+                hierarchy.markDirty(root);
+                hierarchy.update(registry, &pool);
+                return hierarchy.recomputed();
+            };
+
+            // régimen normal: nada cambió desde el cuadro anterior.
+            BENCHMARK("static " + name) {
+                hierarchy.update(registry, &pool);
+                return hierarchy.recomputed();
+            };
+        }
+    }
+}
+
+TEST_CASE("Local matrices", "[transform]") {
+    constexpr std::size_t n = 100'000;
+
+    std::mt19937 rng {13};
+    std::uniform_real_distribution<float> value {-3.0f, 3.0f};
+    std::vector<CTransform> transforms(n);
+    std::vector<const CTransform*> pointers;
+    for (auto& transform : transforms) {
+        transform.position = {value(rng), value(rng), value(rng)};
+        transform.rotation = {value(rng), value(rng), value(rng)};
+        transform.scale = {1.0f, 2.0f, 1.0f};
+        pointers.push_back(&transform);
+    }
+    std::vector<glm::mat4> out(n);
+
+    std::cout << "localMatrices: " << transform_lanes << " transformaciones por tanda\n";
+
+    BENCHMARK("glm translate/rotate/scale 100000") {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = localMatrixGlm(transforms[i]);
+        return out.back()[0][0];
+    };
+
+    BENCHMARK("closed form 100000") {
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = localMatrix(transforms[i]);
+        return out.back()[0][0];
+    };
+
+    BENCHMARK("batch 100000") {
+        localMatrices(pointers.data(), n, out.data());
+        return out.back()[0][0];
+    };
+}
+
+TEST_CASE("Frustum culling", "[culling]") {
+    constexpr std::size_t n = 100'000;
+
+    const glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+    const glm::mat4 proj = glm::perspectiveFov(glm::pi<float>() / 4.0f, 800.0f, 600.0f, 0.1f, 100.0f);
+    const Frustum frustum = frustumFromMatrix(proj * view);
+
+    // cubos repartidos alrededor de la cámara: se ve más o menos un décimo.
+    std::mt19937 rng {17};
+    std::uniform_real_distribution<float> value {-60.0f, 60.0f};
+    std::vector<glm::mat4> models(n);
+    for (auto& model : models)
+        model = glm::translate(glm::mat4(1.0f), {value(rng), value(rng), value(rng)});
+    const glm::vec4 bounds {0.0f, 0.0f, 0.0f, 0.87f};
+
+    SphereSet spheres;
+    for (const auto& model : models)
+        spheres.add(model, bounds);
+    std::vector<std::uint8_t> visible(n);
+
+    std::cout << "cullSpheres: " << cull_lanes << " esferas por tanda, "
+              << cullSpheres(frustum, spheres, visible.data()) << " de " << n << " visibles\n";
+
+    // la misma cantidad de cubos en una jerarquía estática: 100 grupos de 1000, cada grupo
+    // en una celda de 12x12x12, así que la mayoría de los grupos cae entera fuera del frustum.
+    entt::registry registry;
+    TransformHierarchy hierarchy;
+    hierarchy.connect(registry);
+    std::uniform_real_distribution<float> offset {-6.0f, 6.0f};
+    for (std::size_t group = 0; group < n / 1000; ++group) {
+        const auto root = registry.create();
+        registry.emplace<CTransform>(root).position = {value(rng), value(rng), value(rng)};
+        hierarchy.add(root);
+        for (int i = 0; i < 1000; ++i) {
+            const auto leaf = registry.create();
+            registry.emplace<CTransform>(leaf).position = {offset(rng), offset(rng), offset(rng)};
+            registry.emplace<CBounds>(leaf, CBounds {bounds});
+            hierarchy.add(leaf, root);
+        }
+    }
+    hierarchy.update(registry);
+
+    std::vector<TransformHierarchy::Index> visible_nodes;
+    std::cout << "TransformHierarchy::cull: " << hierarchy.cull(frustum, visible_nodes) << " pruebas, "
+              << visible_nodes.size() << " visibles\n";
+
+    BENCHMARK("intersects 100000") {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < n; ++i)
+            count += visible[i] = intersects(frustum, spheres[i]);
+        return count;
+    };
+
+    BENCHMARK("cullSpheres 100000") {
+        return cullSpheres(frustum, spheres, visible.data());
+    };
+
+    BENCHMARK("hierarchy cull 100000") {
+        return hierarchy.cull(frustum, visible_nodes);
+    };
+
+    SphereSet reused = spheres;
+    BENCHMARK("transform + cullSpheres 100000") {
+        reused.clear();
+        for (const auto& model : models)
+            reused.add(model, bounds);
+        return cullSpheres(frustum, reused, visible.data());
+    };
+}
+
+TEST_CASE("Mesh loading", "[mesh]") {
+    // unos 250 mil vértices: índices de 32 bits
+    const ObjMesh mesh = uvSphere(250, 1000);
+    const auto directory = std::filesystem::temp_directory_path();
+    const auto obj_path = (directory / "aux6_bench.obj").string();
+    const auto mesh_path = (directory / "aux6_bench.mesh").string();
+
+    std::ofstream(obj_path) << [&mesh] {
+        std::ostringstream text;
+        writeObj(text, mesh);
+        return text.str();
+    }();
+    const VertexLayout layout = vertexLayout(compact_vertex_format);
+    const auto vertices = packVertices(layout, mesh.vertices.data(), mesh.vertices.size());
+    writeMeshFile(mesh_path, layout, vertices.data(), mesh.vertices.size(), mesh.indices, {0, 0, 0, 1});
+
+    std::cout << mesh.vertices.size() << " vértices, " << mesh.indices.size() / 3 << " triángulos: OBJ de "
+              << std::filesystem::file_size(obj_path) / 1024 << " KiB, .mesh de "
+              << std::filesystem::file_size(mesh_path) / 1024 << " KiB\n";
+
+    BENCHMARK("loadObj") {
+        return loadObj(obj_path).indices.size();
+    };
+
+    BENCHMARK("loadObj + packVertices") {
+        const ObjMesh loaded = loadObj(obj_path);
+        return packVertices(layout, loaded.vertices.data(), loaded.vertices.size()).size();
+    };
+
+    // lo que hace loadMesh() antes de GL: mapear, validar y leer los bytes (como lo haría el
+    // driver al copiarlos al buffer); una suma para que el compilador no se salte la lectura.
+    BENCHMARK("MeshFile") {
+        const MeshFile file {mesh_path};
+        const auto* vertex_bytes = static_cast<const unsigned char*>(file.vertices());
+        const auto* index_bytes = static_cast<const unsigned char*>(file.indices());
+        std::uint32_t sum = 0;
+        for (std::size_t i = 0; i < std::size_t(file.vertexCount()) * std::size_t(layout.stride); i += 64)
+            sum += vertex_bytes[i];
+        for (std::size_t i = 0; i < std::size_t(file.indexCount()) * indexSize(file.indexType()); i += 64)
+            sum += index_bytes[i];
+        return sum;
+    };
+
+    std::filesystem::remove(obj_path);
+    std::filesystem::remove(mesh_path);
+}
\ No newline at end of file
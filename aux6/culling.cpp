@@ -0,0 +1,214 @@
+#include "culling.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX2__)
+#define AUX6_CULLING_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#define AUX6_CULLING_SSE2
+#endif
+
+#if defined(AUX6_CULLING_AVX2) || defined(AUX6_CULLING_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/* operaciones sobre lanes floats, como en transform.cpp. inside() da una máscara con un bit
+ * por lane.
+ */
+#if defined(AUX6_CULLING_AVX2)
+
+constexpr std::size_t lanes = 8;
+using Float = __m256;
+
+inline Float load(const float* p) { return _mm256_loadu_ps(p); }
+inline Float set1(float x) { return _mm256_set1_ps(x); }
+inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+inline Float bitAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+inline Float notLess(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_NLT_UQ); }
+inline Float allTrue() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+inline unsigned bits(Float mask) { return unsigned(_mm256_movemask_ps(mask)); }
+
+#elif defined(AUX6_CULLING_SSE2)
+
+constexpr std::size_t lanes = 4;
+using Float = __m128;
+
+inline Float load(const float* p) { return _mm_loadu_ps(p); }
+inline Float set1(float x) { return _mm_set1_ps(x); }
+inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+inline Float bitAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+inline Float notLess(Float a, Float b) { return _mm_cmpnlt_ps(a, b); }
+inline Float allTrue() { return _mm_castsi128_ps(_mm_set1_epi32(-1)); }
+inline unsigned bits(Float mask) { return unsigned(_mm_movemask_ps(mask)); }
+
+#else
+
+constexpr std::size_t lanes = 1;
+
+#endif
+
+glm::vec4 normalizePlane(const glm::vec4& plane) {
+    return plane / std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+}
+
+}
+
+const std::size_t cull_lanes = lanes;
+
+Frustum frustumFromMatrix(const glm::mat4& view_proj) {
+    // filas de la matriz (glm guarda columnas)
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; ++i)
+        row[i] = {view_proj[0][i], view_proj[1][i], view_proj[2][i], view_proj[3][i]};
+
+    return {{
+        normalizePlane(row[3] + row[0]),    // izquierda
+        normalizePlane(row[3] - row[0]),    // derecha
+        normalizePlane(row[3] + row[1]),    // abajo
+        normalizePlane(row[3] - row[1]),    // arriba
+        normalizePlane(row[3] + row[2]),    // cerca
+        normalizePlane(row[3] - row[2]),    // lejos
+    }};
+}
+
+glm::vec4 boundingSphere(const void* positions, std::size_t count, std::size_t stride) {
+    if (count == 0)
+        return {0.0f, 0.0f, 0.0f, 0.0f};
+
+    auto position = [positions, stride](std::size_t i) {
+        const float* p = reinterpret_cast<const float*>(static_cast<const char*>(positions) + i * stride);
+        return glm::vec3(p[0], p[1], p[2]);
+    };
+
+    // centro de la caja envolvente y la distancia al punto más lejano; no es la esfera mínima,
+    // pero para los meshes del curso queda muy cerca.
+    glm::vec3 low = position(0), high = low;
+    for (std::size_t i = 1; i < count; ++i) {
+        const glm::vec3 p = position(i);
+        for (int k = 0; k < 3; ++k) {
+            low[k] = std::min(low[k], p[k]);
+            high[k] = std::max(high[k], p[k]);
+        }
+    }
+
+    const glm::vec3 center = (low + high) * 0.5f;
+    float radius2 = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 d = position(i) - center;
+        radius2 = std::max(radius2, d.x * d.x + d.y * d.y + d.z * d.z);
+    }
+    return {center, std::sqrt(radius2)};
+}
+
+glm::vec4 transformSphere(const glm::mat4& model, const glm::vec4& sphere) {
+    const glm::vec4 center = model * glm::vec4(sphere.x, sphere.y, sphere.z, 1.0f);
+
+    float scale2 = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+        const glm::vec4& axis = model[column];
+        scale2 = std::max(scale2, axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+    }
+    return {center.x, center.y, center.z, sphere.w * std::sqrt(scale2)};
+}
+
+glm::vec4 mergeSpheres(const glm::vec4& a, const glm::vec4& b) {
+    if (b.w < 0.0f)
+        return a;
+    if (a.w < 0.0f)
+        return b;
+
+    const glm::vec3 d = glm::vec3(b) - glm::vec3(a);
+    const float distance = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+
+    // una dentro de la otra (también cubre los radios infinitos)
+    if (distance + b.w <= a.w)
+        return a;
+    if (distance + a.w <= b.w)
+        return b;
+
+    const float radius = (distance + a.w + b.w) * 0.5f;
+    const glm::vec3 center = glm::vec3(a) + d * ((radius - a.w) / distance);
+    return {center, radius};
+}
+
+void SphereSet::clear() {
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_radius.clear();
+}
+
+void SphereSet::reserve(std::size_t count) {
+    m_x.reserve(count);
+    m_y.reserve(count);
+    m_z.reserve(count);
+    m_radius.reserve(count);
+}
+
+std::size_t SphereSet::add(const glm::mat4& model, const glm::vec4& sphere) {
+    return add(transformSphere(model, sphere));
+}
+
+std::size_t SphereSet::add(const glm::vec4& world) {
+    m_x.push_back(world.x);
+    m_y.push_back(world.y);
+    m_z.push_back(world.z);
+    m_radius.push_back(world.w);
+    return m_x.size() - 1;
+}
+
+std::size_t SphereSet::size() const {
+    return m_x.size();
+}
+
+glm::vec4 SphereSet::operator[](std::size_t i) const {
+    return {m_x[i], m_y[i], m_z[i], m_radius[i]};
+}
+
+std::size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::uint8_t* visible) {
+    const std::size_t count = spheres.size();
+    std::size_t visible_count = 0;
+    std::size_t first = 0;
+
+#if defined(AUX6_CULLING_AVX2) || defined(AUX6_CULLING_SSE2)
+    // distancia con signo de cada centro a cada plano; la esfera queda si ninguna es < -radio.
+    // notLess() también deja pasar NaN, así que una esfera inválida nunca se descarta.
+    Float plane[6][4];
+    for (int p = 0; p < 6; ++p)
+        for (int k = 0; k < 4; ++k)
+            plane[p][k] = set1(frustum.planes[p][k]);
+
+    for (; first + lanes <= count; first += lanes) {
+        const Float x = load(&spheres.m_x[first]);
+        const Float y = load(&spheres.m_y[first]);
+        const Float z = load(&spheres.m_z[first]);
+        const Float radius = load(&spheres.m_radius[first]);
+
+        Float inside = allTrue();
+        for (const auto& p : plane) {
+            const Float distance = add(add(mul(p[0], x), mul(p[1], y)), add(mul(p[2], z), p[3]));
+            inside = bitAnd(inside, notLess(add(distance, radius), set1(0.0f)));
+        }
+
+        const unsigned mask = bits(inside);
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const bool in = (mask >> lane) & 1u;
+            visible[first + lane] = in;
+            visible_count += in;
+        }
+    }
+#endif
+
+    for (; first < count; ++first) {
+        const bool in = intersects(frustum, spheres[first]);
+        visible[first] = in;
+        visible_count += in;
+    }
+
+    return visible_count;
+}
\ No newline at end of file
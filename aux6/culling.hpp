@@ -0,0 +1,91 @@
+#ifndef AUX6__CULLING_HPP
+#define AUX6__CULLING_HPP
+
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/* frustum de la cámara.
+ *
+ * Seis planos (a, b, c, d) normalizados, con a x + b y + c z + d >= 0 hacia adentro, en el
+ * espacio de las coordenadas que transforma la matriz de la que se extrajeron (el mundo, si es
+ * view_proj).
+ */
+struct Frustum {
+    glm::vec4 planes[6];
+};
+
+// planos de la matriz (Gribb y Hartmann), con la convención de clip de OpenGL (-w <= z <= w).
+Frustum frustumFromMatrix(const glm::mat4& view_proj);
+
+// esfera envolvente (centro en xyz, radio en w) de count posiciones vec3 separadas por stride bytes.
+glm::vec4 boundingSphere(const void* positions, std::size_t count, std::size_t stride);
+
+// esfera local (centro y radio en un vec4) llevada a mundo por model; con escala no uniforme
+// el radio crece según el eje más estirado.
+glm::vec4 transformSphere(const glm::mat4& model, const glm::vec4& sphere);
+
+// esfera vacía: no toca ningún frustum y mergeSpheres() la ignora.
+inline glm::vec4 emptySphere() {
+    return {0.0f, 0.0f, 0.0f, -std::numeric_limits<float>::infinity()};
+}
+
+// la esfera más chica que contiene a las dos.
+glm::vec4 mergeSpheres(const glm::vec4& a, const glm::vec4& b);
+
+// esfera envolvente de una entidad en su espacio local (centro en xyz, radio en w); con ella
+// TransformHierarchy mantiene las esferas de cada subárbol (ver TransformHierarchy::cull()).
+struct CBounds {
+    glm::vec4 sphere;
+};
+
+// true si la esfera toca el frustum (o no se puede descartar). Referencia de cullSpheres().
+inline bool intersects(const Frustum& frustum, const glm::vec4& sphere) {
+    for (const glm::vec4& plane : frustum.planes) {
+        const float distance = (plane.x * sphere.x + plane.y * sphere.y) + (plane.z * sphere.z + plane.w);
+        if (distance + sphere.w < 0.0f)
+            return false;
+    }
+    return true;
+}
+
+/* SphereSet
+ *
+ * Esferas en mundo guardadas por componente (x, y, z y radio en arreglos separados), que es
+ * como cullSpheres() las carga en registros SIMD.
+ */
+class SphereSet {
+public:
+    void clear();
+    void reserve(std::size_t count);
+
+    // agrega transformSphere(model, sphere), o una esfera que ya está en mundo; retorna su índice.
+    std::size_t add(const glm::mat4& model, const glm::vec4& sphere);
+    std::size_t add(const glm::vec4& sphere);
+
+    std::size_t size() const;
+    glm::vec4 operator[](std::size_t i) const;
+
+private:
+    friend std::size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::uint8_t* visible);
+
+    std::vector<float> m_x;
+    std::vector<float> m_y;
+    std::vector<float> m_z;
+    std::vector<float> m_radius;
+};
+
+/* cullSpheres
+ *
+ * visible[i] = intersects(frustum, spheres[i]) para todas las esferas, de a cull_lanes a la vez
+ * con SSE2 (4) o AVX2 (8, compilando con AUX6_AVX2). Retorna cuántas son visibles.
+ */
+extern const std::size_t cull_lanes;
+
+std::size_t cullSpheres(const Frustum& frustum, const SphereSet& spheres, std::uint8_t* visible);
+
+#endif //AUX6__CULLING_HPP
\ No newline at end of file
@@ -1,13 +1,29 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <tuple>
+#include <vector>
 
 #include "engine.hpp"
 #include "cube.hpp"
+#include "stream_buffer.hpp"
+#include "profiler.hpp"
+#include "gpu_profiler.hpp"
+#include "program_cache.hpp"
+#include "mesh_file.hpp"
+
+#ifdef AUX6_HEADLESS
+#include "headless.hpp"
+#endif
 
 void onGLFWError(int error_code, const char* description) {
     std::cout << "[GLFW ERROR] " << error_code << " : " << description << std::endl;
@@ -121,16 +137,49 @@ void linkProgram(GLuint program, GLuint vertex, GLuint fragment) {
     glLinkProgram(program);
 }
 
+// caché de programas de makeProgram(); sin él (--no-shader-cache) compila siempre.
+std::unique_ptr<ProgramCache> program_cache;
+
+std::string readFile(const std::string& path) {
+    std::ifstream file {path, std::ios::binary | std::ios::ate};
+    if (!file)
+        return {};
+
+    std::string content(std::size_t(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(content.data(), std::streamsize(content.size()));
+    return content;
+}
+
 GLuint makeProgram(const std::string & vertex, const std::string & fragment) {
-    auto v = loadShader(vertex, GL_VERTEX_SHADER);
-    auto f = loadShader(fragment, GL_FRAGMENT_SHADER);
-    auto program = glCreateProgram();
-    linkProgram(program, v, f);
-    glDeleteShader(f);
-    glDeleteShader(v);
+    const std::string vertex_source = readFile(vertex);
+    const std::string fragment_source = readFile(fragment);
+    const GLuint program = program_cache ? program_cache->program(vertex_source, fragment_source)
+                                         : compileProgram(vertex_source, fragment_source);
+    bindFrameConstants(program);
     return program;
 }
 
+// programas de makeProgramAsync(); se crea con el primero si startPrograms() no lo creó antes.
+std::unique_ptr<ProgramBuilder> program_builder;
+
+ProgramBuilder& programBuilder() {
+    if (!program_builder)
+        program_builder = std::make_unique<ProgramBuilder>(program_cache.get(), bindFrameConstants);
+    return *program_builder;
+}
+
+std::shared_ptr<ProgramHandle> makeProgramAsync(const std::string & vertex, const std::string & fragment) {
+    return programBuilder().build(readFile(vertex), readFile(fragment));
+}
+
+void bindFrameConstants(GLuint program) {
+    // los shaders ya declaran layout(binding = 0), pero así también sirve uno que no lo haga.
+    const GLuint block = glGetUniformBlockIndex(program, "FrameConstants");
+    if (block != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, block, frame_constants_binding);
+}
+
 glm::ivec2 windowResolution() {
     return {800, 600};
 }
@@ -144,83 +193,627 @@ MeshData createCubeMesh() {
 
     glBindVertexArray(vao);
 
+    const GLsizei vertex_count = sizeof(Cube::vertices) / sizeof(Cube::Vertex);
+    const GLsizei index_count = sizeof(Cube::indices) / sizeof(unsigned int);
+
+    const VertexLayout layout = standardVertexLayout();
+    const auto vertices = packVertices(layout, Cube::vertices, vertex_count);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Cube::vertices), Cube::vertices, GL_STATIC_READ);
+    glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size()), vertices.data(), GL_STATIC_READ);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Cube::Vertex), nullptr);     // in vec3 a_position
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Cube::Vertex),               // in vec3 a_normal
-                          reinterpret_cast<void*>(offsetof(Cube::Vertex, normal)));
-    glEnableVertexAttribArray(1);
+    for (const auto& attribute : layout.attributes) {
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized, layout.stride,
+                              reinterpret_cast<void*>(std::uintptr_t(attribute.offset)));
+        glEnableVertexAttribArray(attribute.location);
+    }
 
+    // 24 vértices: los índices caben en 16 bits
+    static_assert(sizeof(Cube::vertices) / sizeof(Cube::Vertex) <= 0x10000);
+    const std::vector<GLushort> indices(std::begin(Cube::indices), std::end(Cube::indices));
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Cube::indices), Cube::indices, GL_STATIC_READ);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GLsizeiptr(indices.size() * sizeof(GLushort)), indices.data(), GL_STATIC_READ);
+
+    return {vao, vbo, ebo, vertex_count, index_count, GL_UNSIGNED_SHORT};
+}
+
+VertexLayout standardVertexLayout() {
+    return vertexLayout(compact_vertex_format);
+}
 
+RMesh createCubeMesh(GeometryPool& pool) {
     const GLsizei vertex_count = sizeof(Cube::vertices) / sizeof(Cube::Vertex);
     const GLsizei index_count = sizeof(Cube::indices) / sizeof(unsigned int);
+    const glm::vec4 bounds = boundingSphere(Cube::vertices, vertex_count, sizeof(Cube::Vertex));
+    const auto vertices = packVertices(pool.layout(), Cube::vertices, vertex_count);
+    return {pool, pool.add(vertices.data(), vertex_count, Cube::indices, index_count), bounds};
+}
 
-    return {vao, vbo, ebo, vertex_count, index_count};
+RMesh addMesh(GeometryPool& pool, const MeshFile& file, const std::string& path) {
+    if (!(file.layout() == pool.layout()))
+        throw std::runtime_error("loadMesh: " + path + " tiene otro formato de vértice que el pool");
+
+    // los bloques mapeados van directo al buffer del pool; el MeshFile se desmapea al salir.
+    const MeshRange range = pool.add(file.vertices(), file.vertexCount(), file.indices(), file.indexType(),
+                                     file.indexCount());
+    return {pool, range, file.bounds()};
 }
 
-void updateTransforms(entt::registry& registry, SceneGraphNode& node, glm::mat4 parent_matrix = glm::mat4(1.0f)) {
+RMesh loadMesh(GeometryPool& pool, const std::string& path) {
+    return addMesh(pool, MeshFile {path}, path);
+}
 
-    auto c_transform = registry.try_get<CTransform>(node.entity);
+RMesh loadMesh(Scene& scene, const std::string& path) {
+    const MeshFile file {path};
+    return addMesh(file.indexType() == GL_UNSIGNED_SHORT ? scene.geometry : scene.large_geometry, file, path);
+}
+
+glm::ivec2 window_size {800, 600};
+
+void frameBufferSizeCallback(GLFWwindow* w, int width, int height) {
+    window_size = {width, height};
+    glViewport(0, 0, width, height);
+}
 
-    glm::mat4 matrix = parent_matrix;
+/* camino instanciado.
+ *
+ * Las entidades cuyo programa tiene variante instanciada se juntan por (programa, mesh): sus
+ * matrices y colores se copian a un buffer de instancias por cuadro (un SSBO que leen
+ * vert_instanced.glsl/frag_instanced.glsl) y cada grupo es un draw instanciado. El shader
+ * encuentra su instancia con gl_BaseInstance + gl_InstanceID.
+ *
+ * Los grupos de meshes de un mismo GeometryPool (y mismo programa) se envían juntos: sus
+ * comandos se escriben en un buffer indirecto y van en un solo glMultiDrawElementsIndirect.
+ */
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color;
+};
+
+struct InstanceItem {
+    const RProgram* program;
+    const GeometryPool* pool;
+    const RMesh* mesh;
+    const glm::mat4* model;
+    glm::vec4 color;
+};
+
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+// una llamada: un glMultiDrawElementsIndirect sobre commands[first, first + count), o un draw
+// instanciado de un mesh fuera de los pools (pool == nullptr, un solo comando).
+struct InstanceDraw {
+    const RProgram* program;
+    const GeometryPool* pool;
+    GLuint vao;
+    GLenum index_type;
+    std::size_t first_command;
+    std::size_t command_count;
+};
+
+struct InstanceBatches {
+    std::vector<InstanceItem> items;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<InstanceDraw> draws;
+};
+
+InstanceBatches instance_batches;
+
+constexpr GLuint instance_buffer_binding = 0;   // layout(binding = 0) buffer Instances
+
+/* datos por cuadro para la GPU (constantes, instancias y comandos indirectos).
+ *
+ * Se escriben directo en la memoria mapeada de un StreamBuffer triple; se crea con el primer
+ * cuadro porque necesita el contexto de GL.
+ */
+std::unique_ptr<StreamBuffer> stream_buffer;
+
+StreamBuffer& streamBuffer() {
+    if (!stream_buffer)
+        stream_buffer = std::make_unique<StreamBuffer>(1 << 20);
+    return *stream_buffer;
+}
 
-    if (c_transform) {
-        matrix = glm::translate(matrix, c_transform->position);
-        matrix = glm::rotate(matrix, c_transform->rotation.y, {0, 1, 0});
-        matrix = glm::rotate(matrix, c_transform->rotation.x, {1, 0, 0});
-        matrix = glm::rotate(matrix, c_transform->rotation.z, {0, 0, 1});
-        matrix = glm::scale(matrix, c_transform->scale);
+// arma los comandos de los items ya ordenados, agrupando en draws.
+void buildInstanceDraws(InstanceBatches& batches) {
+    const auto& items = batches.items;
+    batches.commands.clear();
+    batches.draws.clear();
+
+    std::size_t first = 0;
+    while (first < items.size()) {
+        const RMesh* mesh = items[first].mesh;
+
+        std::size_t last = first + 1;
+        while (last < items.size() && items[last].mesh == mesh && items[last].program == items[first].program)
+            ++last;
+
+        const bool same_draw = !batches.draws.empty() && mesh->pool
+                && batches.draws.back().pool == mesh->pool
+                && batches.draws.back().program == items[first].program;
+        if (!same_draw)
+            batches.draws.push_back({items[first].program, mesh->pool, mesh->vao, mesh->index_type,
+                                     batches.commands.size(), 0});
+
+        batches.commands.push_back({GLuint(mesh->index_count), GLuint(last - first), mesh->first_index,
+                                    mesh->base_vertex, GLuint(first)});
+        ++batches.draws.back().command_count;
+        first = last;
+    }
+}
 
-        c_transform->matrix = matrix;
+void drawInstanced(InstanceBatches& batches, StreamBuffer& stream) {
+    auto& items = batches.items;
+    if (items.empty())
+        return;
+
+    std::sort(items.begin(), items.end(), [](const InstanceItem& a, const InstanceItem& b) {
+        return std::tie(a.program, a.pool, a.mesh) < std::tie(b.program, b.pool, b.mesh);
+    });
+    buildInstanceDraws(batches);
+
+    const auto size = GLsizeiptr(items.size() * sizeof(InstanceData));
+    const auto instances = stream.allocate(size, stream.storageAlignment());
+    auto instance_data = static_cast<InstanceData*>(instances.data);
+    for (std::size_t i = 0; i < items.size(); ++i)
+        instance_data[i] = {*items[i].model, items[i].color};
+
+    const auto commands_size = GLsizeiptr(batches.commands.size() * sizeof(DrawElementsIndirectCommand));
+    const auto commands = stream.allocate(commands_size, 16);
+    std::memcpy(commands.data, batches.commands.data(), commands_size);
+
+    // si commands no cupo, las instancias quedaron en el buffer anterior (que sigue vivo hasta endFrame())
+    glBindBufferRange(GL_SHADER_STORAGE_BUFFER, instance_buffer_binding, instances.buffer, instances.offset, size);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.buffer);
+
+    for (const auto& draw : batches.draws) {
+        glUseProgram(draw.program->instanced_program->get());
+        glBindVertexArray(draw.vao);
+
+        if (draw.pool) {
+            const GLintptr offset = commands.offset + GLintptr(draw.first_command * sizeof(DrawElementsIndirectCommand));
+            glMultiDrawElementsIndirect(GL_TRIANGLES, draw.index_type, reinterpret_cast<const void*>(offset),
+                                        GLsizei(draw.command_count), 0);
+        } else {
+            const auto& command = batches.commands[draw.first_command];
+            glDrawElementsInstancedBaseVertexBaseInstance(
+                    GL_TRIANGLES, GLsizei(command.count), draw.index_type,
+                    reinterpret_cast<const void*>(std::uintptr_t(command.first_index) * indexSize(draw.index_type)),
+                    GLsizei(command.instance_count), command.base_vertex, command.base_instance);
+        }
     }
 
-    for (auto& child : node.children) {
-        updateTransforms(registry, child, matrix);
+    items.clear();
+}
+
+void updateFrameConstants(const FrameConstants& constants, StreamBuffer& stream) {
+    const auto allocation = stream.allocate(sizeof(FrameConstants), stream.uniformAlignment());
+    std::memcpy(allocation.data, &constants, sizeof(FrameConstants));
+    glBindBufferRange(GL_UNIFORM_BUFFER, frame_constants_binding, allocation.buffer, allocation.offset, allocation.size);
+}
+
+/* culling por frustum.
+ *
+ * TransformHierarchy::cull() prueba las esferas de los subárboles y de cada entidad contra los
+ * planos de view_proj; drawScene() solo envía las visibles.
+ */
+struct CullingStats {
+    std::size_t visible {0};        // dibujadas o encoladas para dibujo instanciado
+    std::size_t culled {0};         // descartadas por el frustum
+    std::size_t pending {0};        // dentro del frustum, con el programa todavía construyéndose
+    std::size_t unculled {0};       // CVisual fuera de la jerarquía o sin CBounds: no se dibujan
+};
+
+std::vector<TransformHierarchy::Index> visible_nodes;
+CullingStats culling_stats;     // del último cuadro
+
+void attachBounds(entt::registry& registry, entt::entity entity) {
+    if (const auto& mesh = registry.get<CVisual>(entity).mesh)
+        registry.emplace_or_replace<CBounds>(entity, CBounds {mesh->bounds});
+    else if (registry.try_get<CBounds>(entity))
+        registry.remove<CBounds>(entity);
+}
+
+void detachBounds(entt::registry& registry, entt::entity entity) {
+    if (registry.try_get<CBounds>(entity))
+        registry.remove<CBounds>(entity);
+}
+
+// false si no dibujó nada porque el programa no está listo.
+bool drawEntity(const CTransform& tr, const CVisual& vs) {
+    const auto& instanced = vs.program->instanced_program;
+    if (instanced && instanced->ready()) {
+        instance_batches.items.push_back({vs.program.get(), vs.mesh->pool, vs.mesh.get(), &tr.matrix, vs.color});
+        return true;
     }
+
+    constexpr int u_model_idx = 0;
+    constexpr int u_color_idx = 3;
+
+    const GLuint program = vs.program->program->get();
+    if (!program)
+        return false;       // todavía se está construyendo (o falló)
+
+    glUseProgram(program);
+    glUniformMatrix4fv(u_model_idx, 1, GL_FALSE, glm::value_ptr(tr.matrix));
+    glUniform4fv(u_color_idx, 1, glm::value_ptr(vs.color));
+
+    // el VAO ya tiene asociado el buffer de índices
+    glBindVertexArray(vs.mesh->vao);
+
+    glDrawElementsBaseVertex(GL_TRIANGLES, vs.mesh->index_count, vs.mesh->index_type,
+                             reinterpret_cast<const void*>(std::uintptr_t(vs.mesh->first_index) * indexSize(vs.mesh->index_type)),
+                             vs.mesh->base_vertex);
+    return true;
 }
 
-glm::ivec2 window_size {800, 600};
+// tiempos de GPU de las pasadas de drawScene(); se crea con el primer cuadro, como stream_buffer.
+std::unique_ptr<GpuProfiler> gpu_profiler;
 
-void frameBufferSizeCallback(GLFWwindow* w, int width, int height) {
-    window_size = {width, height};
-    glViewport(0, 0, width, height);
+GpuProfiler& gpuProfiler() {
+    if (!gpu_profiler)
+        gpu_profiler = std::make_unique<GpuProfiler>();
+    return *gpu_profiler;
 }
 
 void drawScene(Scene& scene) {
-    glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    AUX6_PROFILE_ZONE("drawScene");
+    GpuProfiler& gpu = gpuProfiler();
+
+    {
+        AUX6_PROFILE_ZONE("ProgramBuilder::poll");
+        programBuilder().poll();
+    }
+
+    {
+        GpuZone gpu_zone {&gpu, "clear"};
+        glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+    }
+
+    StreamBuffer& stream = streamBuffer();
+    {
+        AUX6_PROFILE_ZONE("StreamBuffer::beginFrame");
+        stream.beginFrame();
+    }
+
+    FrameConstants constants;
+    constants.view = glm::lookAt(scene.camera.eye, scene.camera.at, scene.camera.up);
+    constants.proj = glm::perspectiveFov(glm::pi<float>() / 4.0f, float(window_size.x), float(window_size.y), 0.001f, 1000.0f);
+    constants.view_proj = constants.proj * constants.view;
+    constants.camera_position = glm::vec4(scene.camera.eye, 1.0f);
+    updateFrameConstants(constants, stream);
+
+    {
+        AUX6_PROFILE_ZONE("TransformHierarchy::cull");
+        scene.hierarchy.cull(frustumFromMatrix(constants.view_proj), visible_nodes);
+    }
+
+    CullingStats stats;
+    {
+        AUX6_PROFILE_ZONE("dibujo por entidad");
+        GpuZone gpu_zone {&gpu, "por entidad"};
+
+        const auto& entities = scene.hierarchy.entities();
+        for (auto index : visible_nodes) {
+            const CTransform* tr = scene.registry.try_get<CTransform>(entities[index]);
+            const CVisual* vs = scene.registry.try_get<CVisual>(entities[index]);
+            if (tr && vs)
+                ++(drawEntity(*tr, *vs) ? stats.visible : stats.pending);
+        }
+    }
+    // cull() solo ve nodos con CBounds, y en Scene esos son los que tienen CVisual con mesh
+    // (attachBounds()); los demás CVisual nunca llegan a visible_nodes.
+    const std::size_t bounded = scene.hierarchy.boundedCount();
+    const std::size_t with_visual = scene.registry.view<CVisual>().size();
+    stats.culled = bounded - visible_nodes.size();
+    stats.unculled = with_visual > bounded ? with_visual - bounded : 0;
+    culling_stats = stats;
+
+    {
+        AUX6_PROFILE_ZONE("drawInstanced");
+        GpuZone gpu_zone {&gpu, "instanciado"};
+        drawInstanced(instance_batches, stream);
+    }
+
+    stream.endFrame();
+}
+
+void setupGLState() {
+    glDebugMessageCallback(onGLError, nullptr);
+
+    glClearColor(0.05f, 0.15f, 0.15f, 1.0f);
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+}
+
+/* escena de benchmark.
+ *
+ * count cubos quietos en una grilla centrada en el origen (con la cámara de init() queda más o
+ * menos la mitad fuera del frustum), en grupos de 1000 cubos vecinos bajo un mismo nodo para
+ * que el culling jerárquico tenga subárboles que descartar. Con mesh_path (un .mesh de
+ * mesh_convert) cada celda tiene ese mesh, escalado al tamaño del cubo, en lugar del cubo.
+ */
+std::shared_ptr<RMesh> gridMesh(Scene& scene, const std::string& mesh_path) {
+    if (!mesh_path.empty()) {
+        try {
+            const auto start = std::chrono::steady_clock::now();
+            auto mesh = std::make_shared<RMesh>(loadMesh(scene, mesh_path));
+            std::cout << "mesh: " << mesh_path << ", " << mesh->index_count / 3 << " triángulos, cargado en "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count()
+                      << " ms\n";
+            return mesh;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "; se usa el cubo\n";
+        }
+    }
+    return std::make_shared<RMesh>(createCubeMesh(scene.geometry));
+}
+
+void spawnCubeGrid(Scene& scene, std::size_t count, const std::string& mesh_path) {
+    if (count == 0)
+        return;
+
+    auto program = std::make_shared<RProgram>(makeProgramAsync("vert.glsl", "frag.glsl"),
+                                              makeProgramAsync("vert_instanced.glsl", "frag_instanced.glsl"));
+    auto mesh = gridMesh(scene, mesh_path);
+    // la esfera del cubo unitario tiene radio sqrt(3)/2
+    const float scale = 0.5f * std::sqrt(0.75f) / mesh->bounds.w;
+
+    constexpr std::size_t group_size = 1000;
+    constexpr float spacing = 1.5f;
+    const auto side = std::size_t(std::ceil(std::cbrt(double(count))));
+    const float offset = (float(side) - 1.0f) * spacing * 0.5f;
+
+    entt::entity group = entt::null;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (i % group_size == 0) {
+            group = scene.registry.create();
+            scene.hierarchy.add(group, scene.player);
+            scene.registry.emplace<CTransform>(group);
+        }
+
+        const glm::vec3 cell {float(i % side), float(i / side % side), float(i / (side * side))};
+        const auto cube = scene.registry.create();
+        scene.hierarchy.add(cube, group);
+        auto& transform = scene.registry.emplace<CTransform>(cube);
+        transform.position = cell * spacing - glm::vec3(offset);
+        transform.scale = glm::vec3(scale);
+        scene.registry.emplace<CVisual>(cube, glm::vec4(cell / float(side), 1.0f), mesh, program);
+    }
+}
+
+struct Options {
+    bool headless {false};
+    std::size_t frames {300};
+    std::size_t warmup {10};
+    std::size_t cubes {0};
+    std::string mesh;               // .mesh para la grilla de --cubes; vacío: el cubo
+
+    // trace de Chrome de los cuadros [trace_from, trace_from + trace_frames)
+    std::string trace;
+    std::size_t trace_from {60};
+    std::size_t trace_frames {10};
+
+    std::string shader_cache {"shader_cache"};     // vacío: sin caché
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto value = [&]() {
+            if (i + 1 == argc)
+                throw std::invalid_argument(arg + " necesita un valor");
+            return std::string(argv[++i]);
+        };
+
+        try {
+            if (arg == "--headless")
+                options.headless = true;
+            else if (arg == "--frames")
+                options.frames = std::stoul(value());
+            else if (arg == "--warmup")
+                options.warmup = std::stoul(value());
+            else if (arg == "--cubes")
+                options.cubes = std::stoul(value());
+            else if (arg == "--mesh")
+                options.mesh = value();
+            else if (arg == "--trace")
+                options.trace = value();
+            else if (arg == "--trace-from")
+                options.trace_from = std::stoul(value());
+            else if (arg == "--trace-frames")
+                options.trace_frames = std::stoul(value());
+            else if (arg == "--shader-cache")
+                options.shader_cache = value();
+            else if (arg == "--no-shader-cache")
+                options.shader_cache.clear();
+            else
+                throw std::invalid_argument("opción desconocida " + arg);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n"
+                      << "uso: " << argv[0] << " [--cubes N [--mesh archivo.mesh]] [--headless [--frames N] [--warmup N]]\n"
+                      << "          [--trace archivo.json [--trace-from N] [--trace-frames N]]\n"
+                      << "          [--shader-cache directorio | --no-shader-cache]\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/* inicio del programa.
+ *
+ * startPrograms() crea el caché y el ProgramBuilder antes de init(); reportStartup() muestra
+ * cuánto tardó el inicio y cuánto de eso bloquearon los programas, y reportProgramsReady() (en
+ * cada cuadro) cuándo terminaron de construirse. Con el caché vacío (primera corrida, o después
+ * de actualizar el driver) es el inicio en frío; las siguientes son en caliente.
+ */
+std::chrono::steady_clock::time_point startup_time;
+
+void startPrograms(const Options& options, GLADloadproc load) {
+    if (!options.shader_cache.empty())
+        program_cache = std::make_unique<ProgramCache>(options.shader_cache);
+    program_builder = std::make_unique<ProgramBuilder>(program_cache.get(), bindFrameConstants, load);
+}
+
+double millisecondsSinceStartup() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startup_time).count();
+}
+
+void reportStartup() {
+    const auto& stats = programBuilder().stats();
+    std::cout << "inicio: " << millisecondsSinceStartup() << " ms, programas "
+              << std::chrono::duration<double, std::milli>(stats.submit_time).count() << " ms ("
+              << stats.cached << " del caché, " << programBuilder().pending() << " compilando"
+              << (programBuilder().parallel() ? " en paralelo" : "") << ")\n";
+}
 
-    glm::mat4 view_matrix = glm::lookAt(scene.camera.eye, scene.camera.at, scene.camera.up);
-    glm::mat4 proj_matrix = glm::perspectiveFov(glm::pi<float>() / 4.0f, float(window_size.x), float(window_size.y), 0.001f, 1000.0f);
+void reportProgramsReady() {
+    static bool reported = false;
+    if (reported || programBuilder().pending())
+        return;
 
-    // for each (CTransform, CVisual) in scene->registry
-    scene.registry.view<CTransform, CVisual>().each(
-    [&view_matrix, &proj_matrix](const CTransform& tr, const CVisual& vs) {
-            //auto tr_matrix = glm::translate(glm::mat4 (1.0f), tr.position);
+    const auto& stats = programBuilder().stats();
+    std::cout << "programas listos: " << millisecondsSinceStartup() << " ms (" << stats.cached << " del caché, "
+              << stats.compiled << " compilados, " << stats.failed << " fallidos)\n";
+    reported = true;
+}
 
-            constexpr int u_model_idx = 0;
-            constexpr int u_view_idx = 1;
-            constexpr int u_proj_idx = 2;
-            constexpr int u_color_idx = 3;
+/* un cuadro del loop principal, con zonas del profiler.
+ *
+ * finishFrame() cierra el cuadro en el profiler (después de presentar) y, cuando termina el
+ * rango pedido con --trace, escribe el trace.
+ */
+void runFrame(GLFWwindow* window, Scene& scene, WorkerPool& workers, double delta) {
+    profiler().beginFrame();
+    gpuProfiler().beginFrame();
+
+    {
+        AUX6_PROFILE_ZONE("update");
+        update(window, scene, delta);
+    }
+    {
+        AUX6_PROFILE_ZONE("TransformHierarchy::update");
+        scene.hierarchy.update(scene.registry, &workers);
+    }
+    drawScene(scene);
+    reportProgramsReady();
+}
 
-            glUseProgram(vs.program->program);
-            glUniformMatrix4fv(u_view_idx, 1, GL_FALSE, glm::value_ptr(view_matrix));
-            glUniformMatrix4fv(u_proj_idx, 1, GL_FALSE, glm::value_ptr(proj_matrix));
-            glUniformMatrix4fv(u_model_idx, 1, GL_FALSE, glm::value_ptr(tr.matrix));
-            glUniform4fv(u_color_idx, 1, glm::value_ptr(vs.color));
+void finishFrame(const Options& options) {
+    profiler().endFrame();
 
-            glBindVertexArray(vs.mesh->vao);
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vs.mesh->ebo);
+    static bool written = false;
+    if (options.trace.empty() || written || !profiler().captured())
+        return;
 
-            glDrawElements(GL_TRIANGLES, vs.mesh->index_count, GL_UNSIGNED_INT, nullptr);
+    gpuProfiler().flush();
+    if (profiler().writeChromeTrace(options.trace))
+        std::cout << "trace de los cuadros " << options.trace_from << " a " << options.trace_from + options.trace_frames - 1
+                  << " en " << options.trace << '\n';
+    else
+        std::cerr << "no se pudo escribir " << options.trace << '\n';
+    written = true;
+}
+
+void startProfiler(const Options& options) {
+    profiler().setThreadName("principal");
+    if (!options.trace.empty())
+        profiler().capture(options.trace_from, options.trace_frames);
+}
+
+#ifdef AUX6_HEADLESS
+
+/* modo headless.
+ *
+ * Dibuja options.frames cuadros (más options.warmup que no se miden) en un contexto EGL sin
+ * ventana e imprime estadísticas del tiempo de CPU por cuadro, para medir el camino de render
+ * en máquinas sin GPU ni display (Mesa llvmpipe). El paso de tiempo es fijo, así que dos
+ * corridas con las mismas opciones dibujan lo mismo. Sin swap nada limita a la CPU, así que
+ * cada cuadro termina con glFinish() y el tiempo incluye el render de la GPU (o de llvmpipe).
+ */
+int runHeadless(const Options& options) {
+    std::unique_ptr<HeadlessContext> context;
+    try {
+        context = std::make_unique<HeadlessContext>(window_size.x, window_size.y);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    setupGLState();
+    startPrograms(options, reinterpret_cast<GLADloadproc>(eglGetProcAddress));
+
+    std::vector<double> milliseconds;
+    milliseconds.reserve(options.frames);
+    CullingStats totals;
+    {
+        Scene scene;
+        WorkerPool workers;
+
+        init(nullptr, scene);
+        spawnCubeGrid(scene, options.cubes, options.mesh);
+        reportStartup();
+        startProfiler(options);
+
+        constexpr double delta = 1.0 / 60.0;
+        for (std::size_t frame = 0; frame < options.warmup + options.frames; ++frame) {
+            const auto frame_start = std::chrono::steady_clock::now();
+
+            runFrame(nullptr, scene, workers, delta);
+            {
+                AUX6_PROFILE_ZONE("glFinish");
+                glFinish();
+            }
+            finishFrame(options);
+
+            if (frame < options.warmup)
+                continue;
+            milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frame_start).count());
+            totals.visible += culling_stats.visible;
+            totals.culled += culling_stats.culled;
+            totals.pending += culling_stats.pending;
+            totals.unculled += culling_stats.unculled;
         }
-    );
+    }
+    // los buffers, consultas y programas de GL se liberan antes de destruir el contexto.
+    gpu_profiler.reset();
+    stream_buffer.reset();
+    program_builder.reset();
+    program_cache.reset();
+
+    const FrameTimeStats stats = frameTimeStats(milliseconds);
+    const std::size_t frames = std::max<std::size_t>(options.frames, 1);
+    std::cout << "headless: " << context->renderer() << ", " << window_size.x << "x" << window_size.y << ", "
+              << options.cubes << " cubos, " << options.frames << " cuadros (+" << options.warmup << " de calentamiento)\n"
+              << "cuadro (ms): promedio " << stats.mean << ", mediana " << stats.median << ", p95 " << stats.p95
+              << ", p99 " << stats.p99 << ", mín " << stats.min << ", máx " << stats.max << '\n'
+              << "por cuadro: " << totals.visible / frames << " visibles, " << totals.culled / frames << " descartadas, "
+              << totals.pending / frames << " esperando programa, " << totals.unculled / frames
+              << " sin jerarquía o sin bounds (no se dibujan)\n";
+    return 0;
 }
 
-int main() {
+#endif
+
+int main(int argc, char* argv[]) {
+    startup_time = std::chrono::steady_clock::now();
+
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return 1;
+
+    if (options.headless) {
+#ifdef AUX6_HEADLESS
+        return runHeadless(options);
+#else
+        std::cerr << "--headless: compilado sin EGL\n";
+        return 1;
+#endif
+    }
 
     glfwSetErrorCallback(onGLFWError);
 
@@ -237,17 +830,28 @@ int main() {
 
     gladLoadGLLoader(reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
 
-    glDebugMessageCallback(onGLError, nullptr);
-
-    glClearColor(0.05f, 0.15f, 0.15f, 1.0f);
-    glEnable(GL_DEPTH_TEST);
-    glEnable(GL_CULL_FACE);
+    setupGLState();
+    startPrograms(options, reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
 
     Scene scene;
+    WorkerPool workers;
 
     init(window, scene);
+    spawnCubeGrid(scene, options.cubes, options.mesh);
+    reportStartup();
+    startProfiler(options);
 
     double last = glfwGetTime();
+
+    // matrices recalculadas por cuadro (promedio) y esperas de la CPU a la GPU en el último
+    // segundo, en el título de la ventana.
+    double report_time = last;
+    std::size_t frames = 0;
+    std::size_t recomputed = 0;
+    std::size_t visible = 0;
+    std::size_t culled = 0;
+    std::size_t unculled = 0;
+
     while (!glfwWindowShouldClose(window)) {
         glfwPollEvents();
 
@@ -255,12 +859,41 @@ int main() {
         double delta = now - last;
         last = now;
 
-        update(window, scene, delta);
-        updateTransforms(scene.registry, scene.root);
-        drawScene(scene);
+        runFrame(window, scene, workers, delta);
+
+        ++frames;
+        recomputed += scene.hierarchy.recomputed();
+        visible += culling_stats.visible;
+        culled += culling_stats.culled;
+        unculled += culling_stats.unculled;
+        if (now - report_time >= 1.0) {
+            const std::string title = "Window - " + std::to_string(recomputed / frames) + " transforms/cuadro, "
+                                      + std::to_string(visible / frames) + " visibles, "
+                                      + std::to_string(culled / frames) + " descartadas, "
+                                      + std::to_string(unculled / frames) + " sin culling, "
+                                      + std::to_string(stream_buffer->stats().stalls) + " stalls";
+            glfwSetWindowTitle(window, title.c_str());
+            stream_buffer->resetStats();
+            report_time = now;
+            frames = 0;
+            recomputed = 0;
+            visible = 0;
+            culled = 0;
+            unculled = 0;
+        }
 
-        glfwSwapBuffers(window);
+        {
+            AUX6_PROFILE_ZONE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        finishFrame(options);
     }
 
+    // los buffers, consultas y programas de GL se liberan mientras el contexto sigue vivo.
+    gpu_profiler.reset();
+    stream_buffer.reset();
+    program_builder.reset();
+    program_cache.reset();
+
     return 0;
 }
\ No newline at end of file
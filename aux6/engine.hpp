@@ -15,28 +15,52 @@
 
 #include <string>
 #include <memory>
-#include <forward_list>
-#include <string>
+#include <limits>
+
+#include "transform.hpp"
+#include "hierarchy.hpp"
+#include "geometry_pool.hpp"
+#include "culling.hpp"
+#include "program_builder.hpp"
 
 // utilidades
 GLuint loadShader(const std::string &path, GLenum shader_type);
 void linkProgram(GLuint program, GLuint vertex, GLuint fragment);
 GLuint makeProgram(const std::string & vertex, const std::string & fragment);
+// como makeProgram(), pero sin esperar al driver: el programa queda listo en algún cuadro siguiente.
+std::shared_ptr<ProgramHandle> makeProgramAsync(const std::string & vertex, const std::string & fragment);
+
+/* constantes por cuadro.
+ *
+ * Viven en un uniform buffer que drawScene() actualiza una vez por cuadro y deja asociado al
+ * binding frame_constants_binding; los shaders las leen con
+ *
+ *     layout(std140, binding = 0) uniform FrameConstants { mat4 u_view; mat4 u_proj; ... };
+ *
+ * Agregar una constante es agregar un campo aquí y en el bloque de los shaders, respetando el
+ * layout std140 (campos de 16 bytes: mat4 y vec4).
+ */
+struct FrameConstants {
+    glm::mat4 view;
+    glm::mat4 proj;
+    glm::mat4 view_proj;
+    glm::vec4 camera_position;
+};
+
+constexpr GLuint frame_constants_binding = 0;
+
+// asocia el bloque FrameConstants del programa (si lo usa) a frame_constants_binding.
+void bindFrameConstants(GLuint program);
 
 struct MeshData {
     GLuint vao, vbo, ebo;
     GLsizei vertex_count, index_count;
+    GLenum index_type;
 };
 MeshData createCubeMesh();
 
-struct SceneGraphNode {
-    SceneGraphNode() = default;
-    SceneGraphNode(entt::entity e) : entity(e) {}
-
-    entt::entity entity {entt::null};
-    std::forward_list<SceneGraphNode> children;
-    std::string name;
-};
+// formato de vértice de los meshes del engine: Cube::Vertex empaquetado con compact_vertex_format.
+VertexLayout standardVertexLayout();
 
 struct Camera {
     glm::vec3 eye {1, 1, 1};
@@ -44,36 +68,61 @@ struct Camera {
     glm::vec3 up {0, 1, 0};
 };
 
-// Escena
-struct Scene {
-    entt::registry registry;
-    entt::entity player {registry.create()};
-    SceneGraphNode root {player};
-    Camera camera;
-};
-
 // Recursos
 
 // Mesh
 struct RMesh {
-    RMesh(GLuint vao_, GLuint ebo_, GLsizei index_count_) :
-            vao(vao_), ebo(ebo_), index_count(index_count_)
+    RMesh(GLuint vao_, GLuint ebo_, GLsizei index_count_, GLenum index_type_ = GL_UNSIGNED_INT) :
+            vao(vao_), ebo(ebo_), index_count(index_count_), index_type(index_type_)
     {}
 
     RMesh(const MeshData& mesh_data) :
-            RMesh(mesh_data.vao, mesh_data.ebo, mesh_data.index_count)
+            RMesh(mesh_data.vao, mesh_data.ebo, mesh_data.index_count, mesh_data.index_type)
+    {}
+
+    // un mesh dentro de un GeometryPool: comparte VAO con los demás meshes del pool, así que
+    // drawScene() puede dibujarlos todos con un solo glMultiDrawElementsIndirect.
+    RMesh(const GeometryPool& pool_, const MeshRange& range, const glm::vec4& bounds_) :
+            vao(pool_.vao()), ebo(0), index_count(range.index_count), index_type(pool_.indexType()),
+            first_index(range.first_index), base_vertex(range.base_vertex), pool(&pool_), bounds(bounds_)
     {}
 
     GLuint vao;
     GLuint ebo;
     GLsizei index_count;
+    GLenum index_type;
+    GLuint first_index {0};
+    GLint base_vertex {0};
+    const GeometryPool* pool {nullptr};
+
+    // esfera envolvente en espacio local (centro en xyz, radio en w) para el culling de
+    // drawScene(); con radio infinito el mesh nunca se descarta.
+    glm::vec4 bounds {0.0f, 0.0f, 0.0f, std::numeric_limits<float>::infinity()};
 };
 
+RMesh createCubeMesh(GeometryPool& pool);
+
+// carga un .mesh (ver mesh_file.hpp) al pool; lanza std::runtime_error si no existe, es inválido
+// o sus vértices no tienen el formato del pool, y std::length_error si sus índices no caben en
+// los del pool. Para una escena, loadMesh(Scene&, path) elige el pool.
+RMesh loadMesh(GeometryPool& pool, const std::string& path);
+
 // Shader program
 struct RProgram {
-    RProgram(GLuint p) : program(p) {}
+    RProgram(GLuint p, GLuint instanced = 0) :
+            RProgram(std::make_shared<ProgramHandle>(p), instanced ? std::make_shared<ProgramHandle>(instanced) : nullptr)
+    {}
 
-    GLuint program;
+    RProgram(std::shared_ptr<ProgramHandle> p, std::shared_ptr<ProgramHandle> instanced = nullptr) :
+            program(std::move(p)), instanced_program(std::move(instanced))
+    {}
+
+    // mientras un programa se construye (ver makeProgramAsync()) drawScene() no dibuja con él.
+    std::shared_ptr<ProgramHandle> program;
+    // variante que lee model y color del buffer de instancias (nullptr si no hay); con ella drawScene()
+    // dibuja todas las entidades de un mismo mesh en una sola llamada. Si todavía no está lista se
+    // usa program.
+    std::shared_ptr<ProgramHandle> instanced_program;
 };
 
 // Componentes
@@ -89,14 +138,48 @@ struct CVisual {
     std::shared_ptr<RProgram> program;
 };
 
-// Transformación
-struct CTransform {
-    glm::vec3 position {0, 0, 0};
-    glm::vec3 rotation {0, 0, 0};
-    glm::vec3 scale {1, 1, 1};
-    glm::mat4 matrix {1.0f};
+// asigna a la entidad el CBounds del mesh de su CVisual (o lo saca si el CVisual no tiene mesh).
+void attachBounds(entt::registry& registry, entt::entity entity);
+// saca el CBounds de una entidad que pierde su CVisual.
+void detachBounds(entt::registry& registry, entt::entity entity);
+
+/* Escena
+ *
+ * drawScene() dibuja las entidades de la jerarquía que tienen CVisual y quedan dentro del
+ * frustum. Al agregar o cambiar un CVisual la entidad recibe el CBounds de su mesh, así que la
+ * jerarquía mantiene las esferas de cada subárbol sin que el usuario haga nada. Un CVisual
+ * fuera de la jerarquía o sin mesh no se dibuja; drawScene() lo cuenta aparte.
+ */
+struct Scene {
+    Scene() {
+        hierarchy.connect(registry);
+        registry.on_construct<CVisual>().connect<&attachBounds>();
+        registry.on_update<CVisual>().connect<&attachBounds>();
+        registry.on_destroy<CVisual>().connect<&detachBounds>();
+        hierarchy.add(player);
+    }
+
+    ~Scene() {
+        registry.on_construct<CVisual>().disconnect<&attachBounds>();
+        registry.on_update<CVisual>().disconnect<&attachBounds>();
+        registry.on_destroy<CVisual>().disconnect<&detachBounds>();
+        hierarchy.disconnect(registry);
+    }
+
+    entt::registry registry;
+    entt::entity player {registry.create()};
+    TransformHierarchy hierarchy;
+    Camera camera;
+
+    // geometría compartida por los meshes de la escena (ver RMesh); los de más de 65536 vértices
+    // van a large_geometry, con índices de 32 bits. Un pool sin meshes no crea nada en GL.
+    GeometryPool geometry {standardVertexLayout(), GL_UNSIGNED_SHORT};
+    GeometryPool large_geometry {standardVertexLayout(), GL_UNSIGNED_INT};
 };
 
+// carga un .mesh al pool de la escena que corresponde a su tipo de índice.
+RMesh loadMesh(Scene& scene, const std::string& path);
+
 // definidas por el usuario
 void init(GLFWwindow* window, Scene& scene);
 void update(GLFWwindow* window, Scene &scene, double delta);
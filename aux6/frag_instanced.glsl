@@ -0,0 +1,8 @@
+#version 460
+
+in flat vec4 color;
+out vec4 fragColor;
+
+void main() {
+    fragColor = color;
+}
\ No newline at end of file
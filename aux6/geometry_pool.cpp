@@ -0,0 +1,136 @@
+#include "geometry_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// reemplaza `buffer` por uno de `capacity` bytes con los primeros `used` bytes del anterior.
+GLuint grow(GLuint buffer, GLsizeiptr used, GLsizeiptr capacity) {
+    GLuint grown;
+    glCreateBuffers(1, &grown);
+    glNamedBufferData(grown, capacity, nullptr, GL_STATIC_DRAW);
+    if (buffer) {
+        glCopyNamedBufferSubData(buffer, grown, 0, 0, used);
+        glDeleteBuffers(1, &buffer);
+    }
+    return grown;
+}
+
+}
+
+GeometryPool::GeometryPool(VertexLayout layout, GLenum index_type) :
+m_layout(std::move(layout)),
+m_index_type(index_type)
+{}
+
+GeometryPool::~GeometryPool() {
+    if (m_vao) {
+        glDeleteVertexArrays(1, &m_vao);
+        glDeleteBuffers(1, &m_vbo);
+        glDeleteBuffers(1, &m_ebo);
+    }
+}
+
+MeshRange GeometryPool::add(const void* vertices, GLsizei vertex_count, const GLuint* indices, GLsizei index_count) {
+    return add(vertices, vertex_count, indices, GL_UNSIGNED_INT, index_count);
+}
+
+MeshRange GeometryPool::add(const void* vertices, GLsizei vertex_count, const void* indices, GLenum index_type,
+                            GLsizei index_count) {
+    if (std::size_t(vertex_count) > (std::size_t(1) << 8 * indexSize()))
+        throw std::length_error("GeometryPool::add: el mesh tiene más vértices de los que indexType() permite");
+    if (index_type != GL_UNSIGNED_SHORT && index_type != GL_UNSIGNED_INT)
+        throw std::invalid_argument("GeometryPool::add: index_type debe ser GL_UNSIGNED_SHORT o GL_UNSIGNED_INT");
+
+    if (!m_vao)
+        create();
+
+    const auto index_size = GLsizeiptr(indexSize());
+    const GLsizeiptr vertex_offset = GLsizeiptr(m_vertex_count) * m_layout.stride;
+    const GLsizeiptr index_offset = GLsizeiptr(m_index_count) * index_size;
+    const GLsizeiptr vertex_bytes = GLsizeiptr(vertex_count) * m_layout.stride;
+    const GLsizeiptr index_bytes = GLsizeiptr(index_count) * index_size;
+    reserve(vertex_offset + vertex_bytes, index_offset + index_bytes);
+
+    glNamedBufferSubData(m_vbo, vertex_offset, vertex_bytes, vertices);
+    if (index_type == m_index_type) {
+        glNamedBufferSubData(m_ebo, index_offset, index_bytes, indices);
+    } else if (m_index_type == GL_UNSIGNED_SHORT) {
+        const auto wide = static_cast<const std::uint32_t*>(indices);
+        const std::vector<std::uint16_t> narrow(wide, wide + index_count);
+        glNamedBufferSubData(m_ebo, index_offset, index_bytes, narrow.data());
+    } else {
+        const auto narrow = static_cast<const std::uint16_t*>(indices);
+        const std::vector<std::uint32_t> wide(narrow, narrow + index_count);
+        glNamedBufferSubData(m_ebo, index_offset, index_bytes, wide.data());
+    }
+
+    const MeshRange range {index_count, GLuint(m_index_count), GLint(m_vertex_count)};
+    m_vertex_count += vertex_count;
+    m_index_count += index_count;
+    return range;
+}
+
+const VertexLayout& GeometryPool::layout() const {
+    return m_layout;
+}
+
+GLenum GeometryPool::indexType() const {
+    return m_index_type;
+}
+
+std::size_t GeometryPool::indexSize() const {
+    return ::indexSize(m_index_type);
+}
+
+GLuint GeometryPool::vao() const {
+    return m_vao;
+}
+
+GLuint GeometryPool::vertexBuffer() const {
+    return m_vbo;
+}
+
+GLuint GeometryPool::indexBuffer() const {
+    return m_ebo;
+}
+
+GLsizei GeometryPool::vertexCount() const {
+    return m_vertex_count;
+}
+
+GLsizei GeometryPool::indexCount() const {
+    return m_index_count;
+}
+
+void GeometryPool::create() {
+    glCreateVertexArrays(1, &m_vao);
+    for (const auto& attribute : m_layout.attributes) {
+        glEnableVertexArrayAttrib(m_vao, attribute.location);
+        glVertexArrayAttribFormat(m_vao, attribute.location, attribute.size, attribute.type,
+                                  attribute.normalized, attribute.offset);
+        glVertexArrayAttribBinding(m_vao, attribute.location, 0);
+    }
+
+    // 64k vértices y 256k índices para empezar
+    reserve(GLsizeiptr(m_layout.stride) << 16, GLsizeiptr(indexSize()) << 18);
+}
+
+void GeometryPool::reserve(GLsizeiptr vertex_bytes, GLsizeiptr index_bytes) {
+    if (vertex_bytes > m_vertex_capacity) {
+        const GLsizeiptr capacity = std::max(vertex_bytes, 2 * m_vertex_capacity);
+        m_vbo = grow(m_vbo, GLsizeiptr(m_vertex_count) * m_layout.stride, capacity);
+        m_vertex_capacity = capacity;
+        glVertexArrayVertexBuffer(m_vao, 0, m_vbo, 0, m_layout.stride);
+    }
+
+    if (index_bytes > m_index_capacity) {
+        const GLsizeiptr capacity = std::max(index_bytes, 2 * m_index_capacity);
+        m_ebo = grow(m_ebo, GLsizeiptr(m_index_count) * GLsizeiptr(indexSize()), capacity);
+        m_index_capacity = capacity;
+        glVertexArrayElementBuffer(m_vao, m_ebo);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#ifndef AUX6__GEOMETRY_POOL_HPP
+#define AUX6__GEOMETRY_POOL_HPP
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "vertex_format.hpp"
+
+
+// dónde quedó un mesh dentro del pool, en el formato de DrawElementsIndirectCommand.
+struct MeshRange {
+    GLsizei index_count;
+    GLuint first_index;
+    GLint base_vertex;
+};
+
+/* pool de geometría.
+ *
+ * Todos los meshes con un mismo formato de vértice comparten un VBO, un EBO y un VAO: cada
+ * mesh es un rango de índices (first_index) sobre un rango de vértices (base_vertex). Así
+ * cambiar de mesh no cambia ningún estado de GL, y un cuadro completo se puede enviar con
+ * glMultiDrawElementsIndirect.
+ *
+ * Los índices son de un solo tipo, index_type (GL_UNSIGNED_INT o GL_UNSIGNED_SHORT), para
+ * todo el pool, porque un glMultiDrawElementsIndirect usa un solo tipo. Como son relativos a
+ * base_vertex, GL_UNSIGNED_SHORT alcanza para cualquier cantidad de meshes de hasta 65536
+ * vértices cada uno; add() rechaza uno más grande.
+ *
+ * add() solo agrega al final (los meshes viven lo que vive el pool). Si no hay espacio, los
+ * buffers se reemplazan por otros del doble de tamaño copiando el contenido en la GPU. Los
+ * objetos de GL se crean con el primer add(), así que el pool se puede construir antes que el
+ * contexto.
+ */
+class GeometryPool {
+public:
+    explicit GeometryPool(VertexLayout layout, GLenum index_type = GL_UNSIGNED_INT);
+    ~GeometryPool();
+
+    GeometryPool(const GeometryPool&) = delete;
+    GeometryPool& operator=(const GeometryPool&) = delete;
+
+    // vertices en el formato de layout(), índices relativos al primer vértice del mesh; lanza
+    // std::length_error si el mesh tiene más vértices de los que index_type puede indexar.
+    MeshRange add(const void* vertices, GLsizei vertex_count, const GLuint* indices, GLsizei index_count);
+
+    // índices de tipo index_type; si es el del pool van a GL sin pasar por una copia (MeshFile).
+    // Lanza std::invalid_argument si index_type no es GL_UNSIGNED_SHORT ni GL_UNSIGNED_INT.
+    MeshRange add(const void* vertices, GLsizei vertex_count, const void* indices, GLenum index_type, GLsizei index_count);
+
+    const VertexLayout& layout() const;
+    GLenum indexType() const;
+    std::size_t indexSize() const;
+    GLuint vao() const;
+    GLuint vertexBuffer() const;
+    GLuint indexBuffer() const;
+
+    GLsizei vertexCount() const;
+    GLsizei indexCount() const;
+
+private:
+    VertexLayout m_layout;
+    GLenum m_index_type;
+
+    GLuint m_vao {0};
+    GLuint m_vbo {0};
+    GLuint m_ebo {0};
+    GLsizeiptr m_vertex_capacity {0};    // bytes
+    GLsizeiptr m_index_capacity {0};     // bytes
+
+    GLsizei m_vertex_count {0};
+    GLsizei m_index_count {0};
+
+    void create();
+    void reserve(GLsizeiptr vertex_bytes, GLsizeiptr index_bytes);
+};
+
+#endif //AUX6__GEOMETRY_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "gpu_profiler.hpp"
+
+GpuProfiler::GpuProfiler(Profiler& profiler) : m_profiler(profiler) {}
+
+GpuProfiler::~GpuProfiler() {
+    for (const Pass& pass : m_pending)
+        glDeleteQueries(1, &pass.query);
+    if (m_open.name)
+        glDeleteQueries(1, &m_open.query);
+    if (!m_free.empty())
+        glDeleteQueries(GLsizei(m_free.size()), m_free.data());
+}
+
+void GpuProfiler::beginFrame() {
+    collect(false);
+}
+
+void GpuProfiler::begin(const char* name) {
+    if (!m_profiler.capturing() || m_open.name)
+        return;
+
+    GLuint query;
+    if (m_free.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = m_free.back();
+        m_free.pop_back();
+    }
+
+    m_open = {name, query, m_profiler.now(), m_profiler.frame()};
+    glBeginQuery(GL_TIME_ELAPSED, query);
+}
+
+void GpuProfiler::end() {
+    if (!m_open.name)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    m_pending.push_back(m_open);
+    m_open = {nullptr, 0, 0, 0};
+}
+
+void GpuProfiler::flush() {
+    collect(true);
+}
+
+std::size_t GpuProfiler::pending() const {
+    return m_pending.size();
+}
+
+void GpuProfiler::collect(bool wait) {
+    std::size_t done = 0;
+    for (; done < m_pending.size(); ++done) {
+        const Pass& pass = m_pending[done];
+        if (!wait) {
+            GLint available = GL_FALSE;
+            glGetQueryObjectiv(pass.query, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+        }
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &nanoseconds);
+        m_profiler.record(pass.name, pass.submitted, pass.submitted + std::int64_t(nanoseconds),
+                          Profiler::gpu_track, pass.frame);
+        m_free.push_back(pass.query);
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + done);
+}
\ No newline at end of file
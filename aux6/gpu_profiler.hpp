@@ -0,0 +1,79 @@
+#ifndef AUX6__GPU_PROFILER_HPP
+#define AUX6__GPU_PROFILER_HPP
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "profiler.hpp"
+
+
+/* tiempos de GPU con consultas GL_TIME_ELAPSED.
+ *
+ * begin()/end() (o GpuZone) envuelven una pasada; no se anidan porque GL admite una sola
+ * consulta GL_TIME_ELAPSED activa. Solo se mide mientras el Profiler captura.
+ *
+ * Los resultados no se piden al terminar la pasada sino en los beginFrame() siguientes, y solo
+ * los que GL_QUERY_RESULT_AVAILABLE dice que ya están (las consultas terminan en orden), así que
+ * leerlos nunca detiene a la CPU. Cada resultado va al Profiler como un evento de la pista de
+ * GPU que empieza cuando la CPU envió la pasada y dura lo que midió la GPU. Las consultas se
+ * reciclan en un pool.
+ */
+class GpuProfiler {
+public:
+    explicit GpuProfiler(Profiler& profiler = ::profiler());
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // recoge los resultados que ya están.
+    void beginFrame();
+
+    void begin(const char* name);
+    void end();
+
+    // espera todos los resultados pendientes; para antes de escribir el trace.
+    void flush();
+
+    std::size_t pending() const;
+
+private:
+    struct Pass {
+        const char* name;
+        GLuint query;
+        std::int64_t submitted;
+        std::size_t frame;
+    };
+
+    Profiler& m_profiler;
+    std::vector<Pass> m_pending;    // en orden de envío
+    std::vector<GLuint> m_free;
+    Pass m_open {nullptr, 0, 0, 0};
+
+    void collect(bool wait);
+};
+
+// mide una pasada de GPU; no hace nada si gpu es nullptr.
+class GpuZone {
+public:
+    GpuZone(GpuProfiler* gpu, const char* name) : m_gpu(gpu) {
+        if (m_gpu)
+            m_gpu->begin(name);
+    }
+
+    ~GpuZone() {
+        if (m_gpu)
+            m_gpu->end();
+    }
+
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+
+private:
+    GpuProfiler* m_gpu;
+};
+
+#endif //AUX6__GPU_PROFILER_HPP
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "headless.hpp"
+
+#include <EGL/eglext.h>
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+namespace {
+
+EGLDisplay surfacelessDisplay() {
+    auto get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (!get_platform_display)
+        return EGL_NO_DISPLAY;
+
+    EGLDisplay display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display != EGL_NO_DISPLAY && !eglInitialize(display, nullptr, nullptr))
+        return EGL_NO_DISPLAY;
+    return display;
+}
+
+}
+
+HeadlessContext::HeadlessContext(int width, int height) {
+    m_display = surfacelessDisplay();
+    const bool surfaceless = m_display != EGL_NO_DISPLAY;
+    if (!surfaceless) {
+        m_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (m_display == EGL_NO_DISPLAY || !eglInitialize(m_display, nullptr, nullptr))
+            throw std::runtime_error("HeadlessContext: no hay display de EGL");
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+        throw std::runtime_error("HeadlessContext: EGL no soporta OpenGL");
+
+    const EGLint config_attributes[] {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configs = 0;
+    eglChooseConfig(m_display, config_attributes, &config, 1, &configs);
+    if (configs == 0 && !surfaceless)
+        throw std::runtime_error("HeadlessContext: no hay configuración de EGL con pbuffer");
+
+    // el mismo contexto que pide la versión con ventana.
+    const EGLint context_attributes[] {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 6,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+        EGL_NONE
+    };
+    m_context = eglCreateContext(m_display, configs ? config : EGLConfig(nullptr), EGL_NO_CONTEXT, context_attributes);
+    if (m_context == EGL_NO_CONTEXT)
+        throw std::runtime_error("HeadlessContext: no se pudo crear un contexto OpenGL 4.6 core "
+                                 "(con un Mesa que no anuncia 4.6: MESA_GL_VERSION_OVERRIDE=4.6 "
+                                 "MESA_GLSL_VERSION_OVERRIDE=460)");
+
+    if (!surfaceless) {
+        const EGLint pbuffer_attributes[] {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        m_surface = eglCreatePbufferSurface(m_display, config, pbuffer_attributes);
+    }
+    if (!eglMakeCurrent(m_display, m_surface, m_surface, m_context))
+        throw std::runtime_error("HeadlessContext: eglMakeCurrent falló");
+
+    gladLoadGLLoader(reinterpret_cast<GLADloadproc>(eglGetProcAddress));
+
+    glCreateRenderbuffers(2, m_renderbuffers);
+    glNamedRenderbufferStorage(m_renderbuffers[0], GL_RGBA8, width, height);
+    glNamedRenderbufferStorage(m_renderbuffers[1], GL_DEPTH_COMPONENT24, width, height);
+
+    glCreateFramebuffers(1, &m_framebuffer);
+    glNamedFramebufferRenderbuffer(m_framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_renderbuffers[0]);
+    glNamedFramebufferRenderbuffer(m_framebuffer, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, m_renderbuffers[1]);
+    if (glCheckNamedFramebufferStatus(m_framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        throw std::runtime_error("HeadlessContext: el framebuffer está incompleto");
+
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+HeadlessContext::~HeadlessContext() {
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+        glDeleteRenderbuffers(2, m_renderbuffers);
+    }
+
+    eglMakeCurrent(m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_surface != EGL_NO_SURFACE)
+        eglDestroySurface(m_display, m_surface);
+    if (m_context != EGL_NO_CONTEXT)
+        eglDestroyContext(m_display, m_context);
+    eglTerminate(m_display);
+}
+
+GLuint HeadlessContext::framebuffer() const {
+    return m_framebuffer;
+}
+
+std::string HeadlessContext::renderer() const {
+    return reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+}
+
+FrameTimeStats frameTimeStats(std::vector<double> milliseconds) {
+    if (milliseconds.empty())
+        return {};
+
+    std::sort(milliseconds.begin(), milliseconds.end());
+    auto percentile = [&milliseconds](double p) {
+        return milliseconds[std::size_t(p * double(milliseconds.size() - 1) + 0.5)];
+    };
+
+    FrameTimeStats stats;
+    stats.mean = std::accumulate(milliseconds.begin(), milliseconds.end(), 0.0) / double(milliseconds.size());
+    stats.median = percentile(0.5);
+    stats.p95 = percentile(0.95);
+    stats.p99 = percentile(0.99);
+    stats.min = milliseconds.front();
+    stats.max = milliseconds.back();
+    return stats;
+}
\ No newline at end of file
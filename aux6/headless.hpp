@@ -0,0 +1,49 @@
+#ifndef AUX6__HEADLESS_HPP
+#define AUX6__HEADLESS_HPP
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/* contexto de OpenGL sin ventana.
+ *
+ * Usa EGL sobre la plataforma surfaceless de Mesa, que funciona con llvmpipe en máquinas sin
+ * GPU ni display; si no está, un pbuffer de 1x1 en el display por defecto. Como no hay
+ * framebuffer por defecto, dibuja en un framebuffer propio de width x height (color RGBA8 y
+ * profundidad) que deja asociado. Lanza std::runtime_error si no puede crear el contexto.
+ */
+class HeadlessContext {
+public:
+    HeadlessContext(int width, int height);
+    ~HeadlessContext();
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    GLuint framebuffer() const;
+    std::string renderer() const;
+
+private:
+    EGLDisplay m_display {EGL_NO_DISPLAY};
+    EGLContext m_context {EGL_NO_CONTEXT};
+    EGLSurface m_surface {EGL_NO_SURFACE};
+    GLuint m_framebuffer {0};
+    GLuint m_renderbuffers[2] {0, 0};
+};
+
+// estadísticas de una serie de tiempos por cuadro, en milisegundos.
+struct FrameTimeStats {
+    double mean {0};
+    double median {0};
+    double p95 {0};
+    double p99 {0};
+    double min {0};
+    double max {0};
+};
+
+FrameTimeStats frameTimeStats(std::vector<double> milliseconds);
+
+#endif //AUX6__HEADLESS_HPP
\ No newline at end of file
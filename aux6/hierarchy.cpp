@@ -0,0 +1,406 @@
+#include "hierarchy.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+void TransformHierarchy::add(entt::entity entity, entt::entity parent) {
+    if (contains(entity))
+        throw std::invalid_argument("TransformHierarchy::add: la entidad ya está en la jerarquía");
+
+    Block block;
+    block.entities.push_back(entity);
+    block.parents.push_back(none);
+    block.sizes.push_back(1);
+
+    const Index parent_index = parent == entt::null ? none : checkedIndex(parent);
+    insert(insertionPoint(parent), parent_index, block);
+    markDirty(entity);
+}
+
+std::size_t TransformHierarchy::remove(entt::entity entity) {
+    return extract(checkedIndex(entity)).entities.size();
+}
+
+void TransformHierarchy::reparent(entt::entity entity, entt::entity parent) {
+    const Index index = checkedIndex(entity);
+    if (parent != entt::null) {
+        const Index parent_index = checkedIndex(parent);
+        if (parent_index >= index && parent_index < index + m_sizes[index])
+            throw std::invalid_argument("TransformHierarchy::reparent: el nuevo padre está en el subárbol del nodo");
+    }
+
+    const Block block = extract(index);
+    const Index parent_index = parent == entt::null ? none : checkedIndex(parent);
+    insert(insertionPoint(parent), parent_index, block);
+    markDirty(entity);
+}
+
+bool TransformHierarchy::contains(entt::entity entity) const {
+    return m_index.count(entity) != 0;
+}
+
+TransformHierarchy::Index TransformHierarchy::indexOf(entt::entity entity) const {
+    auto it = m_index.find(entity);
+    return it == m_index.end() ? none : it->second;
+}
+
+entt::entity TransformHierarchy::parent(entt::entity entity) const {
+    const Index parent = m_parents[checkedIndex(entity)];
+    return parent == none ? entt::null : m_entities[parent];
+}
+
+std::size_t TransformHierarchy::size() const {
+    return m_entities.size();
+}
+
+TransformHierarchy::Index TransformHierarchy::subtreeSize(Index index) const {
+    return m_sizes[index];
+}
+
+const std::vector<entt::entity>& TransformHierarchy::entities() const {
+    return m_entities;
+}
+
+const std::vector<TransformHierarchy::Index>& TransformHierarchy::parents() const {
+    return m_parents;
+}
+
+const std::vector<glm::mat4>& TransformHierarchy::worldMatrices() const {
+    return m_world;
+}
+
+const std::vector<glm::vec4>& TransformHierarchy::subtreeBounds() const {
+    return m_bounds;
+}
+
+std::size_t TransformHierarchy::boundedCount() const {
+    return m_bounded;
+}
+
+std::size_t TransformHierarchy::cull(const Frustum& frustum, std::vector<Index>& visible) {
+    m_candidates.clear();
+    m_candidate_spheres.clear();
+    std::size_t tests = 0;
+
+    // las hojas (la mayoría) no se prueban acá sino de a varias al final; un nodo interno
+    // se prueba por su subárbol y, si queda, por su propia esfera junto con las hojas.
+    const auto count = Index(m_entities.size());
+    for (Index i = 0; i < count;) {
+        if (m_sizes[i] > 1) {
+            ++tests;
+            if (!intersects(frustum, m_bounds[i])) {
+                i += m_sizes[i];
+                continue;
+            }
+        }
+
+        if (m_own[i].w >= 0.0f) {
+            m_candidates.push_back(i);
+            m_candidate_spheres.add(m_own[i]);
+        }
+        ++i;
+    }
+
+    m_candidate_visible.resize(m_candidates.size());
+    cullSpheres(frustum, m_candidate_spheres, m_candidate_visible.data());
+    tests += m_candidates.size();
+
+    visible.clear();
+    for (std::size_t i = 0; i < m_candidates.size(); ++i) {
+        if (m_candidate_visible[i])
+            visible.push_back(m_candidates[i]);
+    }
+    return tests;
+}
+
+void TransformHierarchy::connect(entt::registry& registry) {
+    registry.on_construct<CTransform>().connect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_update<CTransform>().connect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_destroy<CTransform>().connect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_construct<CBounds>().connect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_update<CBounds>().connect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_destroy<CBounds>().connect<&TransformHierarchy::onTransformChanged>(*this);
+}
+
+void TransformHierarchy::disconnect(entt::registry& registry) {
+    registry.on_construct<CTransform>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_update<CTransform>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_destroy<CTransform>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_construct<CBounds>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_update<CBounds>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+    registry.on_destroy<CBounds>().disconnect<&TransformHierarchy::onTransformChanged>(*this);
+}
+
+void TransformHierarchy::markDirty(entt::entity entity) {
+    m_dirty.push_back(entity);
+}
+
+void TransformHierarchy::update(entt::registry& registry, WorkerPool* pool) {
+    // con el storage de CTransform en el mismo orden que la jerarquía, los accesos de la pasada
+    // de abajo recorren la memoria de los componentes secuencialmente.
+    if (m_reordered) {
+        registry.sort<CTransform>([this](entt::entity lhs, entt::entity rhs) {
+            return indexOf(lhs) < indexOf(rhs);
+        });
+        m_reordered = false;
+    }
+
+    m_recomputed = 0;
+
+    m_dirty_indices.clear();
+    for (auto entity : m_dirty) {
+        const Index index = indexOf(entity);
+        if (index != none)
+            m_dirty_indices.push_back(index);
+    }
+    m_dirty.clear();
+    std::sort(m_dirty_indices.begin(), m_dirty_indices.end());
+
+    // los hilos solo leen las vistas (no el registry) y cada uno escribe CTransforms distintos.
+    const TransformView transforms = registry.view<CTransform>();
+    const BoundsView bounds = registry.view<CBounds>();
+
+    // en preorden, un nodo sucio dentro de un subárbol ya recalculado no agrega trabajo.
+    m_ranges.clear();
+    Index covered = 0;
+    for (Index first : m_dirty_indices) {
+        if (first < covered)
+            continue;
+        covered = first + m_sizes[first];
+        m_ranges.emplace_back(first, covered);
+        m_recomputed += covered - first;
+    }
+
+    // después de las esferas de los rangos, las de sus ancestros y las de los nodos que
+    // perdieron hijos; de mayor a menor índice, así cada nodo se recalcula después que sus hijos.
+    m_ancestors.clear();
+    for (auto [first, last] : m_ranges) {
+        for (Index ancestor = m_parents[first]; ancestor != none; ancestor = m_parents[ancestor])
+            m_ancestors.push_back(ancestor);
+    }
+    for (auto entity : m_stale) {
+        for (Index ancestor = indexOf(entity); ancestor != none; ancestor = m_parents[ancestor])
+            m_ancestors.push_back(ancestor);
+    }
+    m_stale.clear();
+    std::sort(m_ancestors.begin(), m_ancestors.end(), std::greater<>());
+    m_ancestors.erase(std::unique(m_ancestors.begin(), m_ancestors.end()), m_ancestors.end());
+
+    // m_bounded se corrige con lo que cambió en los rangos (los hilos no lo tocan).
+    for (auto [first, last] : m_ranges)
+        m_bounded -= countBounded(first, last);
+
+    if (!pool || pool->size() == 1) {
+        for (auto [first, last] : m_ranges) {
+            updateRange(transforms, bounds, first, last);
+            mergeRange(first, last);
+        }
+        for (Index ancestor : m_ancestors)
+            mergeChildren(ancestor);
+        for (auto [first, last] : m_ranges)
+            m_bounded += countBounded(first, last);
+        return;
+    }
+
+    // ~8 tareas por hilo para balancear, pero no tan chicas que domine el costo de repartirlas.
+    constexpr Index min_grain = 1024;
+    const Index grain = std::max<Index>(min_grain, Index(m_recomputed / (pool->size() * 8)));
+
+    m_tasks.clear();
+    m_serial.clear();
+    for (auto [first, last] : m_ranges)
+        split(first, last, grain);
+
+    // split() agrega cada raíz antes que sus descendientes, así que este orden es válido.
+    for (Index index : m_serial)
+        updateRange(transforms, bounds, index, index + 1);
+
+    pool->run(m_tasks.size(), [this, &transforms, &bounds](std::size_t task) {
+        AUX6_PROFILE_ZONE("TransformHierarchy tarea");
+        updateRange(transforms, bounds, m_tasks[task].first, m_tasks[task].second);
+        mergeRange(m_tasks[task].first, m_tasks[task].second);
+    });
+
+    // los hijos de una raíz de m_serial son tareas o raíces que aparecen después en m_serial.
+    for (auto it = m_serial.rbegin(); it != m_serial.rend(); ++it)
+        mergeChildren(*it);
+    for (Index ancestor : m_ancestors)
+        mergeChildren(ancestor);
+    for (auto [first, last] : m_ranges)
+        m_bounded += countBounded(first, last);
+}
+
+std::size_t TransformHierarchy::recomputed() const {
+    return m_recomputed;
+}
+
+TransformHierarchy::Index TransformHierarchy::checkedIndex(entt::entity entity) const {
+    const Index index = indexOf(entity);
+    if (index == none)
+        throw std::invalid_argument("TransformHierarchy: la entidad no está en la jerarquía");
+    return index;
+}
+
+// al final del subárbol del padre, para que el nodo quede como su último hijo.
+TransformHierarchy::Index TransformHierarchy::insertionPoint(entt::entity parent) const {
+    if (parent == entt::null)
+        return Index(m_entities.size());
+    const Index index = checkedIndex(parent);
+    return index + m_sizes[index];
+}
+
+TransformHierarchy::Block TransformHierarchy::extract(Index first) {
+    const Index count = m_sizes[first];
+    const Index last = first + count;
+
+    Block block;
+    block.entities.assign(m_entities.begin() + first, m_entities.begin() + last);
+    block.sizes.assign(m_sizes.begin() + first, m_sizes.begin() + last);
+    block.parents.reserve(count);
+    block.parents.push_back(none);
+    for (Index i = first + 1; i < last; ++i)
+        block.parents.push_back(m_parents[i] - first);
+
+    for (Index ancestor = m_parents[first]; ancestor != none; ancestor = m_parents[ancestor])
+        m_sizes[ancestor] -= count;
+    if (m_parents[first] != none)
+        m_stale.push_back(m_entities[m_parents[first]]);
+    for (auto entity : block.entities)
+        m_index.erase(entity);
+    m_bounded -= countBounded(first, last);
+
+    m_entities.erase(m_entities.begin() + first, m_entities.begin() + last);
+    m_parents.erase(m_parents.begin() + first, m_parents.begin() + last);
+    m_sizes.erase(m_sizes.begin() + first, m_sizes.begin() + last);
+    m_world.erase(m_world.begin() + first, m_world.begin() + last);
+    m_own.erase(m_own.begin() + first, m_own.begin() + last);
+    m_bounds.erase(m_bounds.begin() + first, m_bounds.begin() + last);
+
+    // los nodos siguientes se corren `count` posiciones. Sus padres están antes de `first` o
+    // después del bloque: un subárbol es contiguo, así que nadie de afuera cuelga del bloque.
+    for (Index i = first; i < m_entities.size(); ++i) {
+        if (m_parents[i] != none && m_parents[i] >= last)
+            m_parents[i] -= count;
+        m_index[m_entities[i]] = i;
+    }
+
+    m_reordered = true;
+    return block;
+}
+
+void TransformHierarchy::insert(Index position, Index parent, const Block& block) {
+    const auto count = Index(block.entities.size());
+
+    // primero se corren los nodos desde `position` en adelante (el padre está antes).
+    for (Index i = position; i < m_entities.size(); ++i) {
+        if (m_parents[i] != none && m_parents[i] >= position)
+            m_parents[i] += count;
+        m_index[m_entities[i]] = i + count;
+    }
+
+    m_entities.insert(m_entities.begin() + position, block.entities.begin(), block.entities.end());
+    m_sizes.insert(m_sizes.begin() + position, block.sizes.begin(), block.sizes.end());
+    m_world.insert(m_world.begin() + position, count, glm::mat4(1.0f));
+    m_own.insert(m_own.begin() + position, count, emptySphere());
+    m_bounds.insert(m_bounds.begin() + position, count, emptySphere());
+
+    m_parents.insert(m_parents.begin() + position, count, parent);
+    for (Index i = 1; i < count; ++i)
+        m_parents[position + i] = position + block.parents[i];
+
+    for (Index i = 0; i < count; ++i)
+        m_index[block.entities[i]] = position + i;
+    for (Index ancestor = parent; ancestor != none; ancestor = m_parents[ancestor])
+        m_sizes[ancestor] += count;
+
+    m_reordered = true;
+}
+
+void TransformHierarchy::onTransformChanged(entt::registry&, entt::entity entity) {
+    markDirty(entity);
+}
+
+// recalcula [first, last) suponiendo que las matrices de los padres de afuera ya están al día.
+// Las matrices locales se arman de a tandas con localMatrices(); como cada transformación da
+// lo mismo sin importar con cuáles se agrupe, el modo paralelo sigue siendo idéntico al serial.
+void TransformHierarchy::updateRange(const TransformView& transforms, const BoundsView& bounds,
+                                     Index first, Index last) {
+    constexpr Index batch = 32;
+    CTransform* node_transforms[batch];
+    const CTransform* batch_transforms[batch];
+    glm::mat4 locals[batch];
+
+    for (Index begin = first; begin < last; begin += batch) {
+        const Index end = std::min(last, begin + batch);
+
+        std::size_t count = 0;
+        for (Index i = begin; i < end; ++i) {
+            const entt::entity entity = m_entities[i];
+            CTransform* c_transform = transforms.contains(entity) ? &transforms.get<CTransform>(entity) : nullptr;
+            node_transforms[i - begin] = c_transform;
+            if (c_transform)
+                batch_transforms[count++] = c_transform;
+        }
+        localMatrices(batch_transforms, count, locals);
+
+        std::size_t local = 0;
+        for (Index i = begin; i < end; ++i) {
+            const Index parent = m_parents[i];
+            glm::mat4 matrix = parent == none ? glm::mat4(1.0f) : m_world[parent];
+
+            if (CTransform* c_transform = node_transforms[i - begin]) {
+                matrix = matrix * locals[local++];
+                c_transform->matrix = matrix;
+            }
+
+            m_world[i] = matrix;
+
+            const entt::entity entity = m_entities[i];
+            m_own[i] = bounds.contains(entity) ? transformSphere(matrix, bounds.get<CBounds>(entity).sphere) : emptySphere();
+        }
+    }
+}
+
+// esfera del subárbol de `index` a partir de su propia esfera y las de sus hijos.
+void TransformHierarchy::mergeChildren(Index index) {
+    glm::vec4 sphere = m_own[index];
+    const Index end = index + m_sizes[index];
+    for (Index child = index + 1; child < end; child += m_sizes[child])
+        sphere = mergeSpheres(sphere, m_bounds[child]);
+    m_bounds[index] = sphere;
+}
+
+// esferas de los subárboles de [first, last), que tiene que ser un subárbol completo: en
+// preorden inverso los hijos siempre están listos antes que el padre.
+void TransformHierarchy::mergeRange(Index first, Index last) {
+    for (Index i = last; i > first; --i)
+        mergeChildren(i - 1);
+}
+
+std::size_t TransformHierarchy::countBounded(Index first, Index last) const {
+    return std::size_t(std::count_if(m_own.begin() + first, m_own.begin() + last,
+                                     [](const glm::vec4& sphere) { return sphere.w >= 0.0f; }));
+}
+
+// parte el subárbol [first, last) en tareas de a lo más `grain` nodos: la raíz va a m_serial y
+// los subárboles de sus hijos (consecutivos en preorden) se parten de la misma forma. Usa una
+// pila explícita porque una cadena de un millón de nodos desbordaría la recursión.
+void TransformHierarchy::split(Index first, Index last, Index grain) {
+    m_stack.clear();
+    m_stack.emplace_back(first, last);
+    while (!m_stack.empty()) {
+        const auto [root, end] = m_stack.back();
+        m_stack.pop_back();
+
+        if (end - root <= grain) {
+            m_tasks.emplace_back(root, end);
+            continue;
+        }
+
+        m_serial.push_back(root);
+        for (Index child = root + 1; child < end; child += m_sizes[child])
+            m_stack.emplace_back(child, child + m_sizes[child]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#ifndef AUX6__HIERARCHY_HPP
+#define AUX6__HIERARCHY_HPP
+
+#include <entt/entt.hpp>
+#include <glm/mat4x4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "culling.hpp"
+#include "transform.hpp"
+#include "worker_pool.hpp"
+
+
+/* jerarquía de transformaciones.
+ *
+ * Reemplaza al árbol de SceneGraphNode (nodos en el heap enlazados con std::forward_list) por
+ * arreglos paralelos en preorden: los padres siempre quedan antes que sus hijos y el subárbol
+ * de un nodo i ocupa el rango contiguo [i, i + subtreeSize(i)). Así update() calcula todas las
+ * matrices de mundo en una sola pasada lineal, leyendo la matriz del padre desde un arreglo
+ * contiguo en lugar de recorrer punteros.
+ *
+ * add()/remove()/reparent() mantienen ese orden. Insertar al final del subárbol del padre es
+ * O(profundidad) cuando ese subárbol está al final de los arreglos (el caso común al construir
+ * una escena); en general cuesta O(n) porque desplaza los nodos siguientes.
+ *
+ * Los nodos sin CTransform heredan la matriz del padre, igual que antes.
+ *
+ * update() solo recalcula los subárboles marcados como sucios: los nodos nuevos o movidos y
+ * los CTransform creados, borrados o modificados con registry.patch()/replace() (connect()
+ * escucha esas señales de EnTT). Quien modifique un CTransform con registry.get() debe llamar
+ * markDirty(). La geometría estática no cuesta nada después del primer cuadro; recomputed()
+ * dice cuántas matrices se recalcularon en el último update().
+ *
+ * Con un WorkerPool, update() reparte los subárboles sucios entre los hilos: los subárboles
+ * grandes se parten recalculando su raíz en el hilo que llama y repartiendo los subárboles
+ * de sus hijos, que son independientes entre sí. Cada matriz se calcula con exactamente las
+ * mismas operaciones que en modo serial, así que el resultado es idéntico bit a bit.
+ *
+ * Además cada nodo guarda una esfera en mundo que envuelve a su subárbol: la unión de los
+ * CBounds de sus nodos. update() la recalcula para los subárboles sucios y sus ancestros, así
+ * que con geometría estática tampoco cuesta nada. cull() la usa para descartar un subárbol
+ * entero con una sola prueba.
+ */
+class TransformHierarchy {
+public:
+    using Index = std::uint32_t;
+    static constexpr Index none = std::numeric_limits<Index>::max();
+
+    // agrega `entity` como último hijo de `parent`, o como raíz si parent es entt::null.
+    void add(entt::entity entity, entt::entity parent = entt::null);
+
+    // saca `entity` junto con todo su subárbol; retorna cuántos nodos sacó.
+    std::size_t remove(entt::entity entity);
+
+    // mueve `entity` (con su subárbol) para que sea el último hijo de `parent` (o una raíz).
+    void reparent(entt::entity entity, entt::entity parent);
+
+    bool contains(entt::entity entity) const;
+    Index indexOf(entt::entity entity) const;     // none si no está
+    entt::entity parent(entt::entity entity) const;
+
+    std::size_t size() const;
+    Index subtreeSize(Index index) const;
+
+    const std::vector<entt::entity>& entities() const;
+    const std::vector<Index>& parents() const;
+    const std::vector<glm::mat4>& worldMatrices() const;
+    const std::vector<glm::vec4>& subtreeBounds() const;     // emptySphere() si no hay CBounds
+
+    // escribe en `visible` los índices (en preorden) de los nodos con CBounds que tocan el
+    // frustum. Las hojas se prueban de a varias con cullSpheres(); los subárboles cuya esfera
+    // queda afuera se saltan completos. Retorna cuántas esferas probó.
+    std::size_t cull(const Frustum& frustum, std::vector<Index>& visible);
+
+    // nodos con CBounds según el último update(): los que cull() prueba o descarta.
+    std::size_t boundedCount() const;
+
+    // escucha on_construct/on_update/on_destroy de CTransform y CBounds para marcar nodos sucios.
+    void connect(entt::registry& registry);
+    void disconnect(entt::registry& registry);
+
+    // el nodo (y por lo tanto su subárbol) se recalcula en el próximo update().
+    void markDirty(entt::entity entity);
+
+    // recalcula las matrices de mundo de los subárboles sucios y las escribe en CTransform::matrix.
+    // Si se pasa un pool, el trabajo se reparte entre sus hilos.
+    void update(entt::registry& registry, WorkerPool* pool = nullptr);
+
+    // matrices recalculadas en el último update().
+    std::size_t recomputed() const;
+
+private:
+    using TransformView = decltype(std::declval<entt::registry&>().view<CTransform>());
+    using BoundsView = decltype(std::declval<entt::registry&>().view<CBounds>());
+    using Range = std::pair<Index, Index>;
+
+    // un subárbol sacado de los arreglos; los padres son relativos al inicio del bloque.
+    struct Block {
+        std::vector<entt::entity> entities;
+        std::vector<Index> parents;
+        std::vector<Index> sizes;
+    };
+
+    std::vector<entt::entity> m_entities;
+    std::vector<Index> m_parents;
+    std::vector<Index> m_sizes;
+    std::vector<glm::mat4> m_world;
+    std::vector<glm::vec4> m_own;       // CBounds del nodo en mundo
+    std::vector<glm::vec4> m_bounds;    // unión de m_own en el subárbol
+    std::size_t m_bounded {0};          // nodos con m_own no vacía
+    std::unordered_map<entt::entity, Index> m_index;
+
+    // entidades sucias desde el último update(); se traducen a índices recién ahí porque
+    // add()/remove()/reparent() pueden correr los índices.
+    std::vector<entt::entity> m_dirty;
+    std::vector<Index> m_dirty_indices;
+    std::size_t m_recomputed {0};
+
+    // nodos cuyo subárbol perdió nodos (remove()/reparent()): sus esferas se recalculan con
+    // las de sus ancestros en el próximo update().
+    std::vector<entt::entity> m_stale;
+    std::vector<Index> m_ancestors;
+
+    // candidatos de cull(), probados juntos al final
+    std::vector<Index> m_candidates;
+    SphereSet m_candidate_spheres;
+    std::vector<std::uint8_t> m_candidate_visible;
+
+    // subárboles sucios disjuntos; en modo paralelo se parten en m_tasks (independientes entre
+    // sí) y m_serial (raíces que se calculan antes, en serie).
+    std::vector<Range> m_ranges;
+    std::vector<Range> m_tasks;
+    std::vector<Index> m_serial;
+    std::vector<Range> m_stack;
+
+    // la estructura cambió desde el último update(): hay que reordenar el storage de CTransform.
+    bool m_reordered {false};
+
+    Index checkedIndex(entt::entity entity) const;
+    Index insertionPoint(entt::entity parent) const;
+    Block extract(Index first);
+    void insert(Index position, Index parent, const Block& block);
+    void onTransformChanged(entt::registry& registry, entt::entity entity);
+    void updateRange(const TransformView& transforms, const BoundsView& bounds, Index first, Index last);
+    void mergeChildren(Index index);
+    void mergeRange(Index first, Index last);
+    std::size_t countBounded(Index first, Index last) const;
+    void split(Index first, Index last, Index grain);
+};
+
+#endif //AUX6__HIERARCHY_HPP
\ No newline at end of file
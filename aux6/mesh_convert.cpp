@@ -0,0 +1,74 @@
+/* mesh_convert: pasa un OBJ al formato binario .mesh que carga el engine (loadMesh()).
+ *
+ *     mesh_convert entrada.obj salida.mesh
+ *
+ * Los vértices se empaquetan con compact_vertex_format, el formato de la geometría de Scene,
+ * y los índices quedan en 16 bits si el mesh tiene hasta 65536 vértices.
+ *
+ * Las posiciones van en half float: un OBJ con coordenadas de más de 65504 se rechaza, y si el
+ * mesh está lejos del origen respecto de su tamaño se avisa del paso de cuantización.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <iostream>
+
+#include "culling.hpp"
+#include "mesh_file.hpp"
+#include "obj_loader.hpp"
+#include "vertex_format.hpp"
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "uso: " << argv[0] << " entrada.obj salida.mesh\n";
+        return 1;
+    }
+
+    using milliseconds = std::chrono::duration<double, std::milli>;
+    const auto start = std::chrono::steady_clock::now();
+
+    ObjMesh mesh;
+    try {
+        mesh = loadObj(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    if (mesh.vertices.empty() || mesh.indices.empty()) {
+        std::cerr << argv[1] << " no tiene caras\n";
+        return 1;
+    }
+
+    // mayor valor finito de un half float; el paso entre valores en [2^e, 2^(e+1)) es 2^(e-10).
+    constexpr float max_half = 65504.0f;
+    float max_coordinate = 0.0f;
+    for (const auto& vertex : mesh.vertices) {
+        for (int i = 0; i < 3; ++i) max_coordinate = std::max(max_coordinate, std::abs(vertex.position[i]));
+    }
+    if (!(max_coordinate <= max_half)) {
+        std::cerr << argv[1] << ": hay posiciones de hasta " << max_coordinate << ", fuera del rango de half float (±"
+                  << max_half << "); hay que escalar el modelo antes de convertirlo\n";
+        return 1;
+    }
+
+    const glm::vec4 bounds = boundingSphere(mesh.vertices.data(), mesh.vertices.size(), sizeof(Cube::Vertex));
+    const float step = max_coordinate > 0.0f ? std::ldexp(1.0f, std::ilogb(max_coordinate) - 10) : 0.0f;
+    if (step > bounds.w / 256.0f) {
+        std::cerr << "aviso: " << argv[1] << " tiene coordenadas de hasta " << max_coordinate << ", donde el paso de half float es "
+                  << step << " (radio del mesh " << bounds.w << "); conviene centrarlo o escalarlo\n";
+    }
+
+    const VertexLayout layout = vertexLayout(compact_vertex_format);
+    const auto vertices = packVertices(layout, mesh.vertices.data(), mesh.vertices.size());
+
+    if (!writeMeshFile(argv[2], layout, vertices.data(), mesh.vertices.size(), mesh.indices, bounds)) {
+        std::cerr << "no se pudo escribir " << argv[2] << '\n';
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << mesh.vertices.size() << " vértices, " << mesh.indices.size() / 3
+              << " triángulos, índices de " << (indexType(mesh.vertices.size()) == GL_UNSIGNED_SHORT ? 16 : 32)
+              << " bits (" << milliseconds(std::chrono::steady_clock::now() - start).count() << " ms)\n";
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "mesh_file.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char magic[8] {'A', 'U', 'X', '6', 'M', 'S', 'H', '1'};
+constexpr std::uint32_t version = 1;
+constexpr std::uint64_t alignment = 16;
+
+std::uint64_t align(std::uint64_t offset) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+// true si algún índice del bloque no es menor que vertex_count.
+template<typename Index>
+bool indexOutOfRange(const unsigned char* data, std::uint32_t count, std::uint32_t vertex_count) {
+    const auto* indices = reinterpret_cast<const Index*>(data);
+    return std::any_of(indices, indices + count, [vertex_count](Index index) { return index >= vertex_count; });
+}
+
+}
+
+bool writeMeshFile(const std::string& path, const VertexLayout& layout, const void* vertices, std::size_t vertex_count,
+                   const std::vector<std::uint32_t>& indices, const glm::vec4& bounds) {
+    if (layout.attributes.size() > MeshFileHeader::max_attributes)
+        return false;
+
+    MeshFileHeader header {};
+    std::copy(magic, magic + sizeof(magic), header.magic);
+    header.version = version;
+    header.vertex_count = std::uint32_t(vertex_count);
+    header.index_count = std::uint32_t(indices.size());
+    header.index_type = indexType(vertex_count);
+    header.stride = std::uint32_t(layout.stride);
+    header.attribute_count = std::uint32_t(layout.attributes.size());
+    for (std::size_t i = 0; i < layout.attributes.size(); ++i) {
+        const auto& attribute = layout.attributes[i];
+        header.attributes[i] = {attribute.location, std::uint32_t(attribute.size), attribute.type,
+                                attribute.normalized, attribute.offset};
+    }
+    std::copy(&bounds.x, &bounds.x + 4, header.bounds);
+    header.vertex_offset = align(sizeof(header));
+    header.vertex_bytes = std::uint64_t(vertex_count) * std::uint64_t(layout.stride);
+    header.index_offset = align(header.vertex_offset + header.vertex_bytes);
+    header.index_bytes = indices.size() * indexSize(header.index_type);
+
+    std::vector<std::uint16_t> narrow;
+    const void* index_data = indices.data();
+    if (header.index_type == GL_UNSIGNED_SHORT) {
+        narrow.assign(indices.begin(), indices.end());
+        index_data = narrow.data();
+    }
+
+    std::ofstream file {path, std::ios::binary};
+    const char padding[alignment] {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(padding, std::streamsize(header.vertex_offset - sizeof(header)));
+    file.write(static_cast<const char*>(vertices), std::streamsize(header.vertex_bytes));
+    file.write(padding, std::streamsize(header.index_offset - header.vertex_offset - header.vertex_bytes));
+    file.write(static_cast<const char*>(index_data), std::streamsize(header.index_bytes));
+    return bool(file);
+}
+
+MeshFile::MeshFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream file {path, std::ios::binary};
+    if (!file)
+        throw std::runtime_error("MeshFile: no se pudo abrir " + path);
+    m_buffer.assign(std::istreambuf_iterator<char>(file), {});
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+#else
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("MeshFile: no se pudo abrir " + path);
+
+    struct stat status {};
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        m_size = std::size_t(status.st_size);
+        void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        m_data = mapped == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(mapped);
+    }
+    // el mapa sigue válido después de cerrar el descriptor
+    close(fd);
+    if (!m_data) {
+        m_size = 0;
+        throw std::runtime_error("MeshFile: no se pudo mapear " + path);
+    }
+#endif
+
+    // se valida todo antes de entregar punteros: un archivo truncado no debe llegar a GL.
+    auto invalid = [this, &path](const char* reason) {
+        unmap();
+        return std::runtime_error("MeshFile: " + path + " " + reason);
+    };
+    if (m_size < sizeof(MeshFileHeader))
+        throw invalid("es más corto que la cabecera");
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+
+    const MeshFileHeader& h = m_header;
+    if (!std::equal(magic, magic + sizeof(magic), h.magic) || h.version != version)
+        throw invalid("no es un .mesh de esta versión");
+    if (h.attribute_count > MeshFileHeader::max_attributes
+        || (h.index_type != GL_UNSIGNED_SHORT && h.index_type != GL_UNSIGNED_INT)
+        || h.vertex_bytes != std::uint64_t(h.vertex_count) * h.stride
+        || h.index_bytes != std::uint64_t(h.index_count) * indexSize(h.index_type))
+        throw invalid("tiene una cabecera inconsistente");
+    if (h.vertex_offset % alignment || h.index_offset % alignment
+        || h.vertex_offset > m_size || h.vertex_bytes > m_size - h.vertex_offset
+        || h.index_offset > m_size || h.index_bytes > m_size - h.index_offset)
+        throw invalid("está truncado");
+
+    // una pasada por los índices: uno fuera de rango haría leer a GL más allá de los vértices.
+    const unsigned char* indices = m_data + h.index_offset;
+    if (h.index_type == GL_UNSIGNED_SHORT ? indexOutOfRange<std::uint16_t>(indices, h.index_count, h.vertex_count)
+                                          : indexOutOfRange<std::uint32_t>(indices, h.index_count, h.vertex_count))
+        throw invalid("tiene índices fuera de rango");
+}
+
+MeshFile::~MeshFile() {
+    unmap();
+}
+
+VertexLayout MeshFile::layout() const {
+    VertexLayout layout {GLsizei(m_header.stride), {}};
+    for (std::uint32_t i = 0; i < m_header.attribute_count; ++i) {
+        const auto& attribute = m_header.attributes[i];
+        layout.attributes.push_back({attribute.location, GLint(attribute.size), attribute.type,
+                                     GLboolean(attribute.normalized), attribute.offset});
+    }
+    return layout;
+}
+
+GLsizei MeshFile::vertexCount() const {
+    return GLsizei(m_header.vertex_count);
+}
+
+GLsizei MeshFile::indexCount() const {
+    return GLsizei(m_header.index_count);
+}
+
+GLenum MeshFile::indexType() const {
+    return m_header.index_type;
+}
+
+glm::vec4 MeshFile::bounds() const {
+    return {m_header.bounds[0], m_header.bounds[1], m_header.bounds[2], m_header.bounds[3]};
+}
+
+const void* MeshFile::vertices() const {
+    return m_data + m_header.vertex_offset;
+}
+
+const void* MeshFile::indices() const {
+    return m_data + m_header.index_offset;
+}
+
+void MeshFile::unmap() {
+#ifndef _WIN32
+    if (m_data)
+        munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
\ No newline at end of file
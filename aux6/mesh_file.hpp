@@ -0,0 +1,86 @@
+#ifndef AUX6__MESH_FILE_HPP
+#define AUX6__MESH_FILE_HPP
+
+#include <glad/glad.h>
+
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vertex_format.hpp"
+
+
+/* formato binario de meshes (.mesh).
+ *
+ * Una cabecera fija seguida de los vértices, ya empaquetados en el layout que describe la
+ * cabecera, y de los índices, cada bloque alineado a 16 bytes. MeshFile mapea el archivo con
+ * mmap y entrega punteros a esos bloques, que van tal cual a GL (GeometryPool::add()); no hay
+ * nada que parsear ni copiar en la CPU. Los archivos se escriben con mesh_convert desde OBJ.
+ *
+ * Los números se guardan en el orden de bytes de la máquina (little endian en todo lo que
+ * corre el engine).
+ */
+struct MeshFileHeader {
+    static constexpr std::size_t max_attributes = 8;
+
+    struct Attribute {
+        std::uint32_t location;
+        std::uint32_t size;
+        std::uint32_t type;
+        std::uint32_t normalized;
+        std::uint32_t offset;
+    };
+
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t vertex_count;
+    std::uint32_t index_count;
+    std::uint32_t index_type;           // GL_UNSIGNED_SHORT o GL_UNSIGNED_INT
+    std::uint32_t stride;
+    std::uint32_t attribute_count;
+    Attribute attributes[max_attributes];
+    float bounds[4];                    // esfera envolvente: centro y radio
+    std::uint64_t vertex_offset;        // desde el inicio del archivo
+    std::uint64_t vertex_bytes;
+    std::uint64_t index_offset;
+    std::uint64_t index_bytes;
+};
+
+// escribe vertex_count vértices ya empaquetados con layout; los índices quedan en 16 bits si caben.
+bool writeMeshFile(const std::string& path, const VertexLayout& layout, const void* vertices, std::size_t vertex_count,
+                   const std::vector<std::uint32_t>& indices, const glm::vec4& bounds);
+
+// un .mesh mapeado en memoria; el constructor lanza std::runtime_error si el archivo no es válido.
+class MeshFile {
+public:
+    explicit MeshFile(const std::string& path);
+    ~MeshFile();
+
+    MeshFile(const MeshFile&) = delete;
+    MeshFile& operator=(const MeshFile&) = delete;
+
+    VertexLayout layout() const;
+    GLsizei vertexCount() const;
+    GLsizei indexCount() const;
+    GLenum indexType() const;
+    glm::vec4 bounds() const;
+
+    // apuntan dentro del archivo mapeado: valen lo que vive el MeshFile.
+    const void* vertices() const;
+    const void* indices() const;
+
+private:
+    const unsigned char* m_data {nullptr};
+    std::size_t m_size {0};
+    MeshFileHeader m_header {};
+#ifdef _WIN32
+    std::vector<unsigned char> m_buffer;     // sin mmap: el archivo se lee completo
+#endif
+
+    void unmap();
+};
+
+#endif //AUX6__MESH_FILE_HPP
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "obj_loader.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// índices (desde 0, -1 si no hay) de posición, texCoord y normal de un vértice de una cara
+struct Corner {
+    long position {-1};
+    long tex_coord {-1};
+    long normal {-1};
+
+    bool operator==(const Corner& other) const {
+        return position == other.position && tex_coord == other.tex_coord && normal == other.normal;
+    }
+};
+
+struct CornerHash {
+    std::size_t operator()(const Corner& corner) const {
+        std::size_t h = std::hash<long>()(corner.position);
+        h = h * 31 + std::hash<long>()(corner.tex_coord);
+        return h * 31 + std::hash<long>()(corner.normal);
+    }
+};
+
+// índice de OBJ (desde 1, o negativo contando desde el final) a índice desde 0
+long resolve(long index, std::size_t count) {
+    const long resolved = index < 0 ? long(count) + index : index - 1;
+    if (index == 0 || resolved < 0 || resolved >= long(count))
+        throw std::runtime_error("loadObj: índice fuera de rango");
+    return resolved;
+}
+
+// lee "p", "p/t", "p//n" o "p/t/n"; retorna false si no hay más vértices en la cara.
+bool parseCorner(const char*& s, std::size_t positions, std::size_t tex_coords, std::size_t normals, Corner& corner) {
+    char* end;
+    const long position = std::strtol(s, &end, 10);
+    if (end == s)
+        return false;
+    corner = {resolve(position, positions), -1, -1};
+    s = end;
+
+    if (*s == '/') {
+        ++s;
+        if (*s != '/') {
+            corner.tex_coord = resolve(std::strtol(s, &end, 10), tex_coords);
+            s = end;
+        }
+        if (*s == '/') {
+            ++s;
+            corner.normal = resolve(std::strtol(s, &end, 10), normals);
+            s = end;
+        }
+    }
+    return true;
+}
+
+glm::vec3 parseVec3(const char* s) {
+    char* end;
+    glm::vec3 v;
+    v.x = std::strtof(s, &end);
+    v.y = std::strtof(end, &end);
+    v.z = std::strtof(end, &end);
+    return v;
+}
+
+}
+
+ObjMesh loadObj(std::istream& in) {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> tex_coords;
+    std::vector<glm::vec3> normals;
+
+    ObjMesh mesh;
+    std::unordered_map<Corner, std::uint32_t, CornerHash> vertices;
+    std::vector<std::uint32_t> face;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        const char* s = line.c_str();
+        while (*s == ' ' || *s == '\t')
+            ++s;
+
+        if (s[0] == 'v' && s[1] == ' ') {
+            positions.push_back(parseVec3(s + 2));
+        } else if (s[0] == 'v' && s[1] == 'n' && s[2] == ' ') {
+            normals.push_back(parseVec3(s + 3));
+        } else if (s[0] == 'v' && s[1] == 't' && s[2] == ' ') {
+            char* end;
+            glm::vec2 v;
+            v.x = std::strtof(s + 3, &end);
+            v.y = std::strtof(end, &end);
+            tex_coords.push_back(v);
+        } else if (s[0] == 'f' && s[1] == ' ') {
+            face.clear();
+            s += 2;
+            Corner corner;
+            while (parseCorner(s, positions.size(), tex_coords.size(), normals.size(), corner)) {
+                const auto [it, added] = vertices.try_emplace(corner, std::uint32_t(mesh.vertices.size()));
+                if (added) {
+                    Cube::Vertex vertex {positions[corner.position], {}, {}};
+                    if (corner.normal >= 0)
+                        vertex.normal = normals[corner.normal];
+                    if (corner.tex_coord >= 0)
+                        vertex.texCoord = tex_coords[corner.tex_coord];
+                    mesh.vertices.push_back(vertex);
+                }
+                face.push_back(it->second);
+            }
+            if (face.size() < 3)
+                throw std::runtime_error("loadObj: cara con menos de 3 vértices");
+
+            for (std::size_t i = 2; i < face.size(); ++i)
+                mesh.indices.insert(mesh.indices.end(), {face[0], face[i - 1], face[i]});
+        }
+    }
+    return mesh;
+}
+
+ObjMesh loadObj(const std::string& path) {
+    std::ifstream file {path};
+    if (!file)
+        throw std::runtime_error("loadObj: no se pudo abrir " + path);
+    return loadObj(file);
+}
+
+void writeObj(std::ostream& out, const ObjMesh& mesh) {
+    for (const auto& vertex : mesh.vertices) {
+        out << "v " << vertex.position.x << ' ' << vertex.position.y << ' ' << vertex.position.z << '\n'
+            << "vt " << vertex.texCoord.x << ' ' << vertex.texCoord.y << '\n'
+            << "vn " << vertex.normal.x << ' ' << vertex.normal.y << ' ' << vertex.normal.z << '\n';
+    }
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        out << 'f';
+        for (std::size_t j = i; j < i + 3; ++j)
+            out << ' ' << mesh.indices[j] + 1 << '/' << mesh.indices[j] + 1 << '/' << mesh.indices[j] + 1;
+        out << '\n';
+    }
+}
\ No newline at end of file
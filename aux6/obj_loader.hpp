@@ -0,0 +1,32 @@
+#ifndef AUX6__OBJ_LOADER_HPP
+#define AUX6__OBJ_LOADER_HPP
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "cube.hpp"
+
+
+/* meshes en Wavefront OBJ (texto).
+ *
+ * Lee v, vt, vn y f (polígonos convexos, que se triangulan en abanico); ignora el resto. Cada
+ * combinación distinta de posición/texCoord/normal de las caras es un vértice. Es el formato de
+ * entrada de mesh_convert, que lo pasa al formato binario de mesh_file.hpp; el engine no lee
+ * OBJ al correr.
+ */
+struct ObjMesh {
+    std::vector<Cube::Vertex> vertices;
+    std::vector<std::uint32_t> indices;
+};
+
+// lanzan std::runtime_error si el archivo no se puede abrir o una cara es inválida.
+ObjMesh loadObj(std::istream& in);
+ObjMesh loadObj(const std::string& path);
+
+// escribe el mesh con una entrada v/vt/vn por vértice.
+void writeObj(std::ostream& out, const ObjMesh& mesh);
+
+#endif //AUX6__OBJ_LOADER_HPP
\ No newline at end of file
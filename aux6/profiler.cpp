@@ -0,0 +1,140 @@
+#include "profiler.hpp"
+
+#include <fstream>
+
+namespace {
+
+std::atomic<std::uint64_t> next_profiler_id {1};
+
+// nombres de zona escritos como strings de JSON (son literales del programa, pero por las dudas).
+void writeString(std::ostream& out, const char* s) {
+    out << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            out << '\\';
+        out << *s;
+    }
+    out << '"';
+}
+
+}
+
+Profiler::Profiler() : m_id(next_profiler_id++), m_epoch(Clock::now()) {}
+
+void Profiler::capture(std::size_t first_frame, std::size_t frame_count) {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    for (auto& thread : m_threads)
+        thread->events.clear();
+
+    m_first = first_frame;
+    m_last = first_frame + frame_count;
+}
+
+void Profiler::beginFrame() {
+    m_capturing.store(m_frame >= m_first && m_frame < m_last, std::memory_order_relaxed);
+    m_frame_start = now();
+}
+
+void Profiler::endFrame() {
+    if (capturing())
+        record("cuadro", m_frame_start, now());
+    m_capturing.store(false, std::memory_order_relaxed);
+    ++m_frame;
+}
+
+std::size_t Profiler::frame() const {
+    return m_frame;
+}
+
+bool Profiler::capturing() const {
+    return m_capturing.load(std::memory_order_relaxed);
+}
+
+bool Profiler::captured() const {
+    return m_last > m_first && m_frame >= m_last;
+}
+
+std::int64_t Profiler::now() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count();
+}
+
+void Profiler::record(const char* name, std::int64_t start, std::int64_t end) {
+    ThreadEvents& thread = threadEvents();
+    thread.events.push_back({name, start, end, thread.track, std::uint32_t(m_frame)});
+}
+
+void Profiler::record(const char* name, std::int64_t start, std::int64_t end, std::uint32_t track, std::size_t frame) {
+    threadEvents().events.push_back({name, start, end, track, std::uint32_t(frame)});
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    threadEvents().name = name;
+}
+
+std::size_t Profiler::eventCount() const {
+    std::lock_guard<std::mutex> lock {m_mutex};
+    std::size_t count = 0;
+    for (const auto& thread : m_threads)
+        count += thread->events.size();
+    return count;
+}
+
+void Profiler::writeChromeTrace(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock {m_mutex};
+
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << gpu_track
+        << ", \"args\": {\"name\": \"GPU\"}}";
+    for (const auto& thread : m_threads) {
+        out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread->track
+            << ", \"args\": {\"name\": ";
+        writeString(out, thread->name.c_str());
+        out << "}}";
+    }
+
+    // tiempos en microsegundos, como pide el formato.
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const auto& thread : m_threads) {
+        for (const Event& event : thread->events) {
+            out << ",\n{\"name\": ";
+            writeString(out, event.name);
+            out << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.track
+                << ", \"ts\": " << double(event.start) / 1000.0
+                << ", \"dur\": " << double(event.end - event.start) / 1000.0
+                << ", \"args\": {\"cuadro\": " << event.frame << "}}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream file {path};
+    if (!file)
+        return false;
+    writeChromeTrace(file);
+    return bool(file);
+}
+
+Profiler::ThreadEvents& Profiler::threadEvents() {
+    // cada hilo busca su buffer una sola vez; se guarda con el id del profiler al que
+    // pertenece porque los tests usan más de uno (y uno nuevo puede quedar en la misma dirección).
+    thread_local std::uint64_t owner = 0;
+    thread_local ThreadEvents* events = nullptr;
+    if (owner == m_id)
+        return *events;
+
+    std::lock_guard<std::mutex> lock {m_mutex};
+    const auto track = std::uint32_t(m_threads.size() + 1);
+    m_threads.push_back(std::make_unique<ThreadEvents>(ThreadEvents {track, "hilo " + std::to_string(track), {}}));
+    m_threads.back()->events.reserve(1 << 14);
+
+    owner = m_id;
+    events = m_threads.back().get();
+    return *events;
+}
+
+Profiler& profiler() {
+    static Profiler instance;
+    return instance;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#ifndef AUX6__PROFILER_HPP
+#define AUX6__PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/* profiler de cuadros.
+ *
+ * Las zonas (ProfileZone, o la macro AUX6_PROFILE_ZONE) miden un bloque con steady_clock y lo
+ * guardan al cerrarse en un buffer propio del hilo, así que registrar no toma locks ni comparte
+ * líneas de caché entre hilos. Solo se registra mientras se captura el rango de cuadros pedido
+ * con capture(); fuera de él una zona cuesta leer un atomic<bool>.
+ *
+ * beginFrame()/endFrame() (en el hilo principal) cuentan los cuadros y abren y cierran la
+ * captura. Los tiempos de GPU los agrega GpuProfiler con record() en una pista aparte.
+ *
+ * writeChromeTrace() escribe el formato JSON de eventos de Chrome (chrome://tracing, Perfetto):
+ * un evento completo ("X") por zona, con el cuadro en args. Hay que llamarlo entre cuadros,
+ * cuando ningún hilo está dentro de una zona.
+ */
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // pista de los eventos de GPU (los hilos usan 1, 2, ...).
+    static constexpr std::uint32_t gpu_track = 0;
+
+    Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // captura los cuadros [first_frame, first_frame + frame_count); borra lo capturado antes.
+    void capture(std::size_t first_frame, std::size_t frame_count);
+
+    void beginFrame();
+    void endFrame();
+
+    std::size_t frame() const;          // cuadro actual (el primero es el 0)
+    bool capturing() const;
+    bool captured() const;              // el rango pedido ya terminó
+
+    // nanosegundos desde que se creó el profiler.
+    std::int64_t now() const;
+
+    // agrega un evento al buffer del hilo que llama (en su pista, o en `track`).
+    void record(const char* name, std::int64_t start, std::int64_t end);
+    void record(const char* name, std::int64_t start, std::int64_t end, std::uint32_t track, std::size_t frame);
+
+    // nombre de la pista del hilo que llama (por defecto "hilo N").
+    void setThreadName(const std::string& name);
+
+    std::size_t eventCount() const;
+    void writeChromeTrace(std::ostream& out) const;
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    struct Event {
+        const char* name;
+        std::int64_t start;
+        std::int64_t end;
+        std::uint32_t track;
+        std::uint32_t frame;
+    };
+
+    struct ThreadEvents {
+        std::uint32_t track;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    const std::uint64_t m_id;          // distingue profilers en los buffers thread_local
+    Clock::time_point m_epoch;
+    std::atomic<bool> m_capturing {false};
+    std::size_t m_frame {0};
+    std::size_t m_first {0};
+    std::size_t m_last {0};
+    std::int64_t m_frame_start {0};
+
+    mutable std::mutex m_mutex;     // solo para registrar hilos nuevos
+    std::vector<std::unique_ptr<ThreadEvents>> m_threads;
+
+    ThreadEvents& threadEvents();
+};
+
+// el profiler del programa.
+Profiler& profiler();
+
+// mide desde su construcción hasta su destrucción.
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name, Profiler& profiler = ::profiler()) :
+            m_profiler(profiler), m_name(name), m_start(profiler.capturing() ? profiler.now() : -1)
+    {}
+
+    ~ProfileZone() {
+        if (m_start >= 0)
+            m_profiler.record(m_name, m_start, m_profiler.now());
+    }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    Profiler& m_profiler;
+    const char* m_name;
+    std::int64_t m_start;
+};
+
+#define AUX6_PROFILE_CONCAT_(a, b) a##b
+#define AUX6_PROFILE_CONCAT(a, b) AUX6_PROFILE_CONCAT_(a, b)
+#define AUX6_PROFILE_ZONE(name) ProfileZone AUX6_PROFILE_CONCAT(profile_zone_, __LINE__) {name}
+
+#endif //AUX6__PROFILER_HPP
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include "program_builder.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// GL_KHR_parallel_shader_compile; glad se generó sin la extensión.
+constexpr GLenum completion_status = 0x91B1;        // GL_COMPLETION_STATUS_KHR
+constexpr GLuint all_threads = 0xFFFFFFFF;          // el driver elige cuántos hilos
+using MaxShaderCompilerThreads = void (APIENTRYP)(GLuint count);
+
+bool hasExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i) {
+        const auto extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, GLuint(i)));
+        if (extension && std::strcmp(extension, name) == 0)
+            return true;
+    }
+    return false;
+}
+
+}
+
+ProgramHandle::ProgramHandle(GLuint program) :
+m_program(program),
+m_status(program ? Status::Ready : Status::Failed)
+{}
+
+ProgramHandle::Status ProgramHandle::status() const {
+    return m_status;
+}
+
+bool ProgramHandle::ready() const {
+    return m_status == Status::Ready;
+}
+
+GLuint ProgramHandle::get() const {
+    return ready() ? m_program : 0;
+}
+
+ProgramBuilder::ProgramBuilder(ProgramCache* cache, std::function<void(GLuint)> on_ready, GLADloadproc load) :
+m_cache(cache),
+m_on_ready(std::move(on_ready)),
+m_parallel(hasExtension("GL_KHR_parallel_shader_compile"))
+{
+    // la cantidad de hilos por omisión ya la elige el driver; pedirlo explícito por si acaso.
+    if (m_parallel && load) {
+        if (auto max_threads = reinterpret_cast<MaxShaderCompilerThreads>(load("glMaxShaderCompilerThreadsKHR")))
+            max_threads(all_threads);
+    }
+}
+
+ProgramBuilder::~ProgramBuilder() {
+    for (auto& pending : m_pending) {
+        glDeleteShader(pending.vertex);
+        glDeleteShader(pending.fragment);
+        glDeleteProgram(pending.handle->m_program);
+        pending.handle->m_program = 0;
+        pending.handle->m_status = ProgramHandle::Status::Failed;
+    }
+}
+
+std::shared_ptr<ProgramHandle> ProgramBuilder::build(std::string vertex_source, std::string fragment_source) {
+    const auto start = std::chrono::steady_clock::now();
+    auto handle = std::make_shared<ProgramHandle>();
+
+    if (const GLuint cached = m_cache ? m_cache->find(vertex_source, fragment_source) : 0) {
+        if (m_on_ready)
+            m_on_ready(cached);
+        handle->m_program = cached;
+        handle->m_status = ProgramHandle::Status::Ready;
+        ++m_stats.cached;
+    } else {
+        Pending pending {handle, compileShader(vertex_source, GL_VERTEX_SHADER),
+                         compileShader(fragment_source, GL_FRAGMENT_SHADER),
+                         std::move(vertex_source), std::move(fragment_source)};
+        handle->m_program = glCreateProgram();
+        handle->m_status = ProgramHandle::Status::Building;
+        glProgramParameteri(handle->m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glAttachShader(handle->m_program, pending.vertex);
+        glAttachShader(handle->m_program, pending.fragment);
+        glLinkProgram(handle->m_program);
+        m_pending.push_back(std::move(pending));
+    }
+
+    m_stats.submit_time += std::chrono::steady_clock::now() - start;
+    return handle;
+}
+
+std::size_t ProgramBuilder::poll() {
+    auto done = std::stable_partition(m_pending.begin(), m_pending.end(), [this](const Pending& pending) {
+        return !completed(pending);
+    });
+    std::for_each(done, m_pending.end(), [this](Pending& pending) { finish(pending); });
+    m_pending.erase(done, m_pending.end());
+    return m_pending.size();
+}
+
+std::size_t ProgramBuilder::pending() const {
+    return m_pending.size();
+}
+
+bool ProgramBuilder::parallel() const {
+    return m_parallel;
+}
+
+const ProgramBuilder::Stats& ProgramBuilder::stats() const {
+    return m_stats;
+}
+
+bool ProgramBuilder::completed(const Pending& pending) const {
+    if (!m_parallel)
+        return true;
+
+    GLint status = GL_FALSE;
+    glGetProgramiv(pending.handle->m_program, completion_status, &status);
+    return status == GL_TRUE;
+}
+
+void ProgramBuilder::finish(Pending& pending) {
+    ProgramHandle& handle = *pending.handle;
+
+    // & y no &&: así se muestran los logs de todos los que fallaron
+    const bool ok = checkCompile(pending.vertex) & checkCompile(pending.fragment) & checkLink(handle.m_program);
+    glDetachShader(handle.m_program, pending.vertex);
+    glDetachShader(handle.m_program, pending.fragment);
+    glDeleteShader(pending.vertex);
+    glDeleteShader(pending.fragment);
+
+    if (!ok) {
+        glDeleteProgram(handle.m_program);
+        handle.m_program = 0;
+        handle.m_status = ProgramHandle::Status::Failed;
+        ++m_stats.failed;
+        return;
+    }
+
+    if (m_cache)
+        m_cache->insert(pending.vertex_source, pending.fragment_source, handle.m_program);
+    if (m_on_ready)
+        m_on_ready(handle.m_program);
+    handle.m_status = ProgramHandle::Status::Ready;
+    ++m_stats.compiled;
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef AUX6__PROGRAM_BUILDER_HPP
+#define AUX6__PROGRAM_BUILDER_HPP
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "program_cache.hpp"
+
+
+/* programa que se construye en segundo plano.
+ *
+ * get() retorna 0 mientras el driver compila y enlaza, y también si falló; quien dibuja con él
+ * (drawScene()) se salta las entidades hasta que esté listo.
+ */
+class ProgramHandle {
+public:
+    enum class Status {
+        Building, Ready, Failed
+    };
+
+    // un programa ya enlazado (0 cuenta como fallido)
+    explicit ProgramHandle(GLuint program = 0);
+
+    Status status() const;
+    bool ready() const;
+    GLuint get() const;
+
+private:
+    friend class ProgramBuilder;
+
+    GLuint m_program;
+    Status m_status;
+};
+
+/* compilación de programas sin bloquear al hilo principal.
+ *
+ * build() envía la compilación y el enlace y retorna enseguida; poll(), una vez por cuadro,
+ * revisa los pendientes y marca listos los que terminaron. Con GL_KHR_parallel_shader_compile
+ * el driver compila en sus hilos y poll() pregunta GL_COMPLETION_STATUS_KHR, que no bloquea.
+ * Sin la extensión la pregunta por el estado espera al driver, así que poll() igual bloquea,
+ * pero recién en el primer cuadro y no durante init().
+ *
+ * Si hay ProgramCache, build() primero busca ahí (el programa queda listo de inmediato) y los
+ * que se compilan se guardan al terminar. on_ready se llama con cada programa enlazado, antes
+ * de marcarlo listo.
+ */
+class ProgramBuilder {
+public:
+    struct Stats {
+        std::size_t cached {0};     // listos en build(), desde el caché
+        std::size_t compiled {0};
+        std::size_t failed {0};
+        std::chrono::nanoseconds submit_time {0};   // dentro de build(), en el hilo principal
+    };
+
+    // load busca glMaxShaderCompilerThreadsKHR (p.ej. glfwGetProcAddress); puede ser nullptr.
+    explicit ProgramBuilder(ProgramCache* cache = nullptr, std::function<void(GLuint)> on_ready = {},
+                            GLADloadproc load = nullptr);
+    ~ProgramBuilder();
+
+    ProgramBuilder(const ProgramBuilder&) = delete;
+    ProgramBuilder& operator=(const ProgramBuilder&) = delete;
+
+    std::shared_ptr<ProgramHandle> build(std::string vertex_source, std::string fragment_source);
+
+    // retorna cuántos programas siguen pendientes.
+    std::size_t poll();
+
+    std::size_t pending() const;
+    bool parallel() const;
+    const Stats& stats() const;
+
+private:
+    struct Pending {
+        std::shared_ptr<ProgramHandle> handle;
+        GLuint vertex;
+        GLuint fragment;
+        std::string vertex_source;      // para guardarlo en el caché
+        std::string fragment_source;
+    };
+
+    ProgramCache* m_cache;
+    std::function<void(GLuint)> m_on_ready;
+    bool m_parallel {false};
+    std::vector<Pending> m_pending;
+    Stats m_stats;
+
+    bool completed(const Pending& pending) const;
+    void finish(Pending& pending);
+};
+
+#endif //AUX6__PROGRAM_BUILDER_HPP
\ No newline at end of file
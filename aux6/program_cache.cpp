@@ -0,0 +1,214 @@
+#include "program_cache.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// cabecera de cada archivo del caché; key repite la llave para descartar colisiones de nombre.
+struct Header {
+    char magic[8];
+    std::uint64_t key;
+    GLenum format;
+    GLsizei size;
+};
+
+constexpr char magic[8] {'A', 'U', 'X', '6', 'P', 'R', 'G', '1'};
+
+// FNV-1a de 64 bits
+std::uint64_t hash(const std::string& s, std::uint64_t h = 14695981039346656037ull) {
+    for (unsigned char c : s)
+        h = (h ^ c) * 1099511628211ull;
+    // separador, para que ("ab", "c") y ("a", "bc") den distinto
+    return (h ^ 0xffu) * 1099511628211ull;
+}
+
+std::string glString(GLenum name) {
+    const auto s = reinterpret_cast<const char*>(glGetString(name));
+    return s ? s : "";
+}
+
+bool linked(GLuint program) {
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    return status == GL_TRUE;
+}
+
+}
+
+GLuint compileShader(const std::string& source, GLenum shader_type) {
+    const GLuint shader = glCreateShader(shader_type);
+    const char* c_str = source.c_str();
+    glShaderSource(shader, 1, &c_str, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+bool checkCompile(GLuint shader) {
+    GLint status = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status)
+        return true;
+
+    GLint length = 0;
+    glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+    std::string log(static_cast<std::size_t>(std::max(length, 1)), '\0');
+    glGetShaderInfoLog(shader, length, nullptr, log.data());
+    std::cout << "[SHADER ERROR]\n" << log << std::endl;
+    return false;
+}
+
+bool checkLink(GLuint program) {
+    if (linked(program))
+        return true;
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+    std::string log(static_cast<std::size_t>(std::max(length, 1)), '\0');
+    glGetProgramInfoLog(program, length, nullptr, log.data());
+    std::cout << "[PROGRAM ERROR]\n" << log << std::endl;
+    return false;
+}
+
+GLuint compileProgram(const std::string& vertex_source, const std::string& fragment_source) {
+    const GLuint vertex = compileShader(vertex_source, GL_VERTEX_SHADER);
+    const GLuint fragment = compileShader(fragment_source, GL_FRAGMENT_SHADER);
+
+    const GLuint program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+
+    // & y no &&: así se muestran los logs de todos los que fallaron
+    const bool ok = checkCompile(vertex) & checkCompile(fragment) & checkLink(program);
+    glDetachShader(program, vertex);
+    glDetachShader(program, fragment);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    if (!ok) {
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+ProgramCache::ProgramCache(std::string directory) : m_directory(std::move(directory)) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    m_enabled = formats > 0 && !error;
+
+    m_driver_hash = hash(glString(GL_VENDOR));
+    m_driver_hash = hash(glString(GL_RENDERER), m_driver_hash);
+    m_driver_hash = hash(glString(GL_VERSION), m_driver_hash);
+    m_driver_hash = hash(glString(GL_SHADING_LANGUAGE_VERSION), m_driver_hash);
+}
+
+GLuint ProgramCache::program(const std::string& vertex_source, const std::string& fragment_source) {
+    const auto start = std::chrono::steady_clock::now();
+
+    GLuint program = find(vertex_source, fragment_source);
+    if (!program) {
+        program = compileProgram(vertex_source, fragment_source);
+        insert(vertex_source, fragment_source, program);
+    }
+
+    m_stats.time += std::chrono::steady_clock::now() - start;
+    return program;
+}
+
+GLuint ProgramCache::find(const std::string& vertex_source, const std::string& fragment_source) {
+    const GLuint program = m_enabled ? load(key(vertex_source, fragment_source)) : 0;
+    if (program)
+        ++m_stats.hits;
+    else
+        ++m_stats.misses;
+    return program;
+}
+
+void ProgramCache::insert(const std::string& vertex_source, const std::string& fragment_source, GLuint program) {
+    if (program && m_enabled)
+        store(key(vertex_source, fragment_source), program);
+}
+
+bool ProgramCache::enabled() const {
+    return m_enabled;
+}
+
+const ProgramCache::Stats& ProgramCache::stats() const {
+    return m_stats;
+}
+
+std::uint64_t ProgramCache::key(const std::string& vertex_source, const std::string& fragment_source) const {
+    return hash(fragment_source, hash(vertex_source, m_driver_hash));
+}
+
+std::string ProgramCache::path(std::uint64_t key) const {
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_directory + "/" + name;
+}
+
+GLuint ProgramCache::load(std::uint64_t key) {
+    std::ifstream file {path(key), std::ios::binary};
+    if (!file)
+        return 0;
+
+    Header header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || !std::equal(magic, magic + sizeof(magic), header.magic) || header.key != key || header.size <= 0)
+        return 0;
+
+    std::vector<char> binary(static_cast<std::size_t>(header.size));
+    if (!file.read(binary.data(), header.size))
+        return 0;
+
+    const GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), header.size);
+    if (linked(program))
+        return program;
+
+    // binario de otro driver o corrupto: se borra y se vuelve a compilar.
+    ++m_stats.rejected;
+    glDeleteProgram(program);
+    file.close();
+    std::error_code error;
+    std::filesystem::remove(path(key), error);
+    return 0;
+}
+
+void ProgramCache::store(std::uint64_t key, GLuint program) {
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return;
+
+    Header header {};
+    std::copy(magic, magic + sizeof(magic), header.magic);
+    header.key = key;
+    std::vector<char> binary(static_cast<std::size_t>(size));
+    glGetProgramBinary(program, size, &header.size, &header.format, binary.data());
+    if (header.size <= 0)
+        return;
+
+    // se escribe a un temporal y se renombra, así un proceso que lee al mismo tiempo nunca ve un archivo a medias.
+    const std::string final_path = path(key);
+    const std::string temporary = final_path + ".tmp";
+    {
+        std::ofstream file {temporary, std::ios::binary};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(binary.data(), header.size);
+        if (!file)
+            return;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, final_path, error);
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef AUX6__PROGRAM_CACHE_HPP
+#define AUX6__PROGRAM_CACHE_HPP
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/* caché en disco de programas enlazados.
+ *
+ * program() busca un binario (glGetProgramBinary) guardado para esas fuentes y lo carga con
+ * glProgramBinary; si no hay, o el driver lo rechaza (otro driver, otra versión), compila y
+ * enlaza desde las fuentes y guarda el binario nuevo. La llave es un hash de las fuentes y de
+ * GL_VENDOR, GL_RENDERER, GL_VERSION y GL_SHADING_LANGUAGE_VERSION, así que actualizar el
+ * driver o cambiar un shader invalida la entrada en lugar de cargar un binario equivocado.
+ *
+ * Si el driver no ofrece formatos de binario (GL_NUM_PROGRAM_BINARY_FORMATS = 0) siempre compila.
+ */
+class ProgramCache {
+public:
+    struct Stats {
+        std::size_t hits {0};           // cargados del caché
+        std::size_t misses {0};         // compilados (no estaban o fueron rechazados)
+        std::size_t rejected {0};       // binarios que el driver no aceptó
+        std::chrono::nanoseconds time {0};
+    };
+
+    explicit ProgramCache(std::string directory);
+
+    GLuint program(const std::string& vertex_source, const std::string& fragment_source);
+
+    // las dos mitades de program(), para quien compila por su cuenta (ProgramBuilder):
+    // find() retorna el programa guardado o 0; insert() guarda uno ya enlazado.
+    GLuint find(const std::string& vertex_source, const std::string& fragment_source);
+    void insert(const std::string& vertex_source, const std::string& fragment_source, GLuint program);
+
+    bool enabled() const;
+    const Stats& stats() const;
+
+private:
+    std::string m_directory;
+    std::uint64_t m_driver_hash {0};
+    bool m_enabled {false};
+    Stats m_stats;
+
+    std::uint64_t key(const std::string& vertex_source, const std::string& fragment_source) const;
+    std::string path(std::uint64_t key) const;
+    GLuint load(std::uint64_t key);
+    void store(std::uint64_t key, GLuint program);
+};
+
+// compila y enlaza sin caché; retorna 0 (y muestra el log) si algo falla.
+GLuint compileProgram(const std::string& vertex_source, const std::string& fragment_source);
+
+// envía la compilación; el resultado se revisa después con checkCompile().
+GLuint compileShader(const std::string& source, GLenum shader_type);
+
+// muestran el log y retornan false si la compilación del shader o el enlace del programa falló.
+bool checkCompile(GLuint shader);
+bool checkLink(GLuint program);
+
+#endif //AUX6__PROGRAM_CACHE_HPP
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "stream_buffer.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+}
+
+GLsizeiptr alignedFrameSize(GLsizeiptr size, GLsizeiptr alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+StreamBuffer::StreamBuffer(GLsizeiptr frame_size, GLuint frames) :
+m_frame_size(0),
+m_frames(std::max<GLuint>(frames, 1)),
+m_fences(m_frames, nullptr)
+{
+    GLint uniform_alignment = 1;
+    GLint storage_alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+    m_uniform_alignment = std::max<GLsizeiptr>(uniform_alignment, 1);
+    m_storage_alignment = std::max<GLsizeiptr>(storage_alignment, 1);
+    m_alignment = std::max<GLsizeiptr>({m_alignment, m_uniform_alignment, m_storage_alignment});
+
+    create(alignedFrameSize(frame_size, m_alignment));
+}
+
+StreamBuffer::~StreamBuffer() {
+    retire();
+    deleteRetired();
+}
+
+void StreamBuffer::beginFrame() {
+    m_used = 0;
+
+    GLsync& fence = m_fences[m_frame];
+    if (!fence)
+        return;
+
+    // sin esperar: si la GPU ya terminó con la región no hay stall.
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        const auto start = std::chrono::steady_clock::now();
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        ++m_stats.stalls;
+        m_stats.stall_time += std::chrono::steady_clock::now() - start;
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::endFrame() {
+    m_fences[m_frame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    m_frame = (m_frame + 1) % m_frames;
+    ++m_stats.frames;
+
+    deleteRetired();
+}
+
+StreamBuffer::Allocation StreamBuffer::allocate(GLsizeiptr size, GLsizeiptr alignment) {
+    GLsizeiptr offset = (m_used + alignment - 1) / alignment * alignment;
+
+    if (offset + size > m_frame_size) {
+        // lo ya asignado en este cuadro sigue en el buffer anterior (y ya fue escrito), así que
+        // basta con que el nuevo tenga espacio para esta asignación. El anterior se borra en
+        // endFrame(): borrarlo ahora lo desligaría de los bindings que todavía lo usan.
+        retire();
+        create(alignedFrameSize(std::max(2 * m_frame_size, size + alignment), std::max(m_alignment, alignment)));
+        ++m_stats.resizes;
+        offset = 0;
+    }
+
+    m_used = offset + size;
+    const GLintptr absolute = GLintptr(m_frame) * m_frame_size + offset;
+    return {m_mapped + absolute, m_buffer, absolute, size};
+}
+
+GLuint StreamBuffer::buffer() const {
+    return m_buffer;
+}
+
+GLsizeiptr StreamBuffer::frameSize() const {
+    return m_frame_size;
+}
+
+GLsizeiptr StreamBuffer::uniformAlignment() const {
+    return m_uniform_alignment;
+}
+
+GLsizeiptr StreamBuffer::storageAlignment() const {
+    return m_storage_alignment;
+}
+
+const StreamBuffer::Stats& StreamBuffer::stats() const {
+    return m_stats;
+}
+
+void StreamBuffer::resetStats() {
+    m_stats = {};
+}
+
+void StreamBuffer::create(GLsizeiptr frame_size) {
+    m_frame_size = frame_size;
+
+    glCreateBuffers(1, &m_buffer);
+    glNamedBufferStorage(m_buffer, m_frame_size * m_frames, nullptr, map_flags);
+    m_mapped = static_cast<char*>(glMapNamedBufferRange(m_buffer, 0, m_frame_size * m_frames, map_flags));
+}
+
+void StreamBuffer::retire() {
+    for (auto& fence : m_fences) {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (m_buffer)
+        m_retired.push_back(m_buffer);
+    m_buffer = 0;
+    m_mapped = nullptr;
+}
+
+void StreamBuffer::deleteRetired() {
+    // borrar un buffer que la GPU todavía lee es válido: GL lo libera cuando termina.
+    for (GLuint buffer : m_retired) {
+        glUnmapNamedBuffer(buffer);
+        glDeleteBuffers(1, &buffer);
+    }
+    m_retired.clear();
+}
\ No newline at end of file
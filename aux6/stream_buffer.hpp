@@ -0,0 +1,91 @@
+#ifndef AUX6__STREAM_BUFFER_HPP
+#define AUX6__STREAM_BUFFER_HPP
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+
+/* buffer de streaming para datos que cambian cada cuadro.
+ *
+ * Un solo buffer creado con glBufferStorage y mapeado de forma persistente y coherente, partido
+ * en `frames` regiones (3 por defecto): en cada cuadro se escribe directo a la memoria mapeada
+ * de una región mientras la GPU todavía puede estar leyendo las de los cuadros anteriores. No
+ * hay glBufferData/glBufferSubData, así que el driver no copia ni sincroniza nada.
+ *
+ * Al terminar el cuadro, endFrame() deja una fence; beginFrame() espera la fence de la región que
+ * va a reusar. Si la GPU va atrasada esa espera bloquea a la CPU: stats() cuenta esas esperas
+ * (stalls) y cuánto duraron.
+ *
+ * allocate() reparte la región del cuadro actual (instancias, uniforms, vértices dinámicos, ...).
+ * Si un cuadro no cabe, el buffer se reemplaza por uno más grande; el anterior lo libera el
+ * driver cuando la GPU deja de usarlo. El tamaño de región siempre es múltiplo de la mayor
+ * alineación de offsets de uniform y storage buffers, así que los offsets de allocate() sirven
+ * para glBindBufferRange en cualquier región.
+ */
+class StreamBuffer {
+public:
+    struct Allocation {
+        void* data;         // memoria mapeada donde escribir
+        GLuint buffer;      // buffer donde quedó: un allocate() posterior puede reemplazar buffer()
+        GLintptr offset;    // offset en buffer para glBindBufferRange, glBindVertexBuffer, ...
+        GLsizeiptr size;
+    };
+
+    struct Stats {
+        std::size_t frames {0};
+        std::size_t stalls {0};
+        std::chrono::nanoseconds stall_time {0};
+        std::size_t resizes {0};
+    };
+
+    explicit StreamBuffer(GLsizeiptr frame_size, GLuint frames = 3);
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    void beginFrame();
+    void endFrame();
+
+    // size bytes de la región del cuadro actual, con offset múltiplo de alignment.
+    Allocation allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+    GLuint buffer() const;
+    GLsizeiptr frameSize() const;
+
+    // alineaciones que pide el contexto para glBindBufferRange; sirven de alignment en allocate().
+    GLsizeiptr uniformAlignment() const;
+    GLsizeiptr storageAlignment() const;
+
+    const Stats& stats() const;
+    void resetStats();
+
+private:
+    GLuint m_buffer {0};
+    char* m_mapped {nullptr};
+    GLsizeiptr m_frame_size;
+    GLuint m_frames;
+
+    GLuint m_frame {0};         // región actual
+    GLsizeiptr m_used {0};      // bytes usados en la región actual
+    std::vector<GLsync> m_fences;
+    std::vector<GLuint> m_retired;
+
+    Stats m_stats;
+
+    GLsizeiptr m_uniform_alignment {1};     // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    GLsizeiptr m_storage_alignment {1};     // GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+    GLsizeiptr m_alignment {16};            // la mayor de las dos (y al menos 16)
+
+    void create(GLsizeiptr frame_size);
+    void retire();
+    void deleteRetired();
+};
+
+// el menor múltiplo de alignment que es >= size: con él, frame * frame_size queda alineado en todas las regiones.
+GLsizeiptr alignedFrameSize(GLsizeiptr size, GLsizeiptr alignment);
+
+#endif //AUX6__STREAM_BUFFER_HPP
\ No newline at end of file
@@ -0,0 +1,587 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include "cube.hpp"
+#include "culling.hpp"
+#include "hierarchy.hpp"
+#include "mesh_file.hpp"
+#include "obj_loader.hpp"
+#include "profiler.hpp"
+#include "stream_buffer.hpp"
+#include "transform.hpp"
+#include "vertex_format.hpp"
+#include "worker_pool.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// verifica el invariante de la jerarquía: cada padre está antes que sus hijos y cada nodo cae
+// dentro del rango de su padre.
+void checkOrder(const TransformHierarchy& hierarchy) {
+    const auto& parents = hierarchy.parents();
+    for (TransformHierarchy::Index i = 0; i < hierarchy.size(); ++i) {
+        REQUIRE(hierarchy.indexOf(hierarchy.entities()[i]) == i);
+        const auto parent = parents[i];
+        if (parent != TransformHierarchy::none) {
+            REQUIRE(parent < i);
+            REQUIRE(i < parent + hierarchy.subtreeSize(parent));
+        }
+    }
+}
+
+float maxDifference(const glm::mat4& a, const glm::mat4& b) {
+    float difference = 0.0f;
+    for (int column = 0; column < 4; ++column)
+        for (int row = 0; row < 4; ++row)
+            difference = std::max(difference, std::abs(a[column][row] - b[column][row]));
+    return difference;
+}
+
+entt::entity spawn(entt::registry& registry, TransformHierarchy& hierarchy, entt::entity parent, glm::vec3 position) {
+    const auto entity = registry.create();
+    registry.emplace<CTransform>(entity).position = position;
+    hierarchy.add(entity, parent);
+    return entity;
+}
+
+}
+
+TEST_CASE("TransformHierarchy") {
+    entt::registry registry;
+    TransformHierarchy hierarchy;
+    hierarchy.connect(registry);
+
+    const auto a = spawn(registry, hierarchy, entt::null, {1, 0, 0});
+    const auto b = spawn(registry, hierarchy, a, {0, 1, 0});
+    const auto c = spawn(registry, hierarchy, b, {0, 0, 1});
+    const auto d = spawn(registry, hierarchy, entt::null, {2, 0, 0});
+    const auto e = spawn(registry, hierarchy, a, {0, 2, 0});
+
+    REQUIRE(hierarchy.size() == 5);
+    REQUIRE(hierarchy.entities() == std::vector<entt::entity> {a, b, c, e, d});
+    REQUIRE(hierarchy.parent(c) == b);
+    checkOrder(hierarchy);
+
+    hierarchy.update(registry);
+    REQUIRE(hierarchy.recomputed() == 5);
+    REQUIRE(registry.get<CTransform>(c).matrix[3] == glm::vec4(1, 1, 1, 1));
+
+    SECTION("solo se recalculan los subárboles sucios") {
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 0);
+
+        registry.patch<CTransform>(c, [](CTransform& tr) { tr.position.z = 3; });
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 1);
+
+        registry.patch<CTransform>(a, [](CTransform& tr) { tr.position.x = 5; });
+        registry.patch<CTransform>(b, [](CTransform& tr) { tr.position.y = 2; });
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 4);
+        REQUIRE(registry.get<CTransform>(c).matrix[3] == glm::vec4(5, 2, 3, 1));
+    }
+
+    SECTION("reparent") {
+        hierarchy.reparent(b, d);
+        checkOrder(hierarchy);
+        REQUIRE(hierarchy.entities() == std::vector<entt::entity> {a, e, d, b, c});
+        REQUIRE(hierarchy.parent(b) == d);
+
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 2);
+        REQUIRE(registry.get<CTransform>(c).matrix[3] == glm::vec4(2, 1, 1, 1));
+
+        REQUIRE_THROWS_AS(hierarchy.reparent(d, c), std::invalid_argument);
+        REQUIRE_THROWS_AS(hierarchy.add(c), std::invalid_argument);
+    }
+
+    SECTION("remove") {
+        REQUIRE(hierarchy.remove(b) == 2);
+        checkOrder(hierarchy);
+        REQUIRE(hierarchy.entities() == std::vector<entt::entity> {a, e, d});
+        REQUIRE_FALSE(hierarchy.contains(c));
+        REQUIRE(hierarchy.subtreeSize(0) == 2);
+    }
+
+    hierarchy.disconnect(registry);
+}
+
+TEST_CASE("TransformHierarchy edits keep the order") {
+    std::mt19937 rng {10};
+    entt::registry registry;
+    TransformHierarchy hierarchy;
+
+    std::vector<entt::entity> nodes;
+    for (int step = 0; step < 2000; ++step) {
+        const auto op = rng() % 8;
+        if (op < 5 || nodes.size() < 2) {
+            const auto parent = nodes.empty() || rng() % 4 == 0 ? entt::entity(entt::null) : nodes[rng() % nodes.size()];
+            nodes.push_back(spawn(registry, hierarchy, parent, {0, 0, 0}));
+        } else if (op < 6) {
+            hierarchy.remove(nodes[rng() % nodes.size()]);
+            nodes = hierarchy.entities();
+        } else {
+            const auto node = nodes[rng() % nodes.size()];
+            const auto parent = nodes[rng() % nodes.size()];
+            const auto index = hierarchy.indexOf(node);
+            const auto parent_index = hierarchy.indexOf(parent);
+            if (parent_index >= index && parent_index < index + hierarchy.subtreeSize(index))
+                REQUIRE_THROWS(hierarchy.reparent(node, parent));
+            else
+                hierarchy.reparent(node, parent);
+        }
+    }
+    checkOrder(hierarchy);
+}
+
+TEST_CASE("TransformHierarchy parallel update") {
+    std::mt19937 rng {12};
+    std::uniform_real_distribution<float> value {-2.0f, 2.0f};
+
+    // dos escenas iguales, una se actualiza en serie y la otra en paralelo.
+    entt::registry serial_registry, parallel_registry;
+    TransformHierarchy serial, parallel;
+
+    std::vector<entt::entity> nodes;
+    for (int i = 0; i < 50'000; ++i) {
+        CTransform transform;
+        transform.position = {value(rng), value(rng), value(rng)};
+        transform.rotation = {value(rng), value(rng), value(rng)};
+        transform.scale = {1.0f + 0.1f * value(rng), 1.0f, 1.0f};
+
+        // mezcla de cadenas largas y nodos con muchos hijos.
+        const auto parent = nodes.empty() || rng() % 50 == 0 ? entt::entity(entt::null)
+                : nodes[rng() % 2 ? nodes.size() - 1 : rng() % nodes.size()];
+
+        const auto entity = serial_registry.create();
+        REQUIRE(parallel_registry.create() == entity);
+        serial_registry.emplace<CTransform>(entity, transform);
+        parallel_registry.emplace<CTransform>(entity, transform);
+        serial_registry.emplace<CBounds>(entity, CBounds {{0, 0, 0, 0.5f}});
+        parallel_registry.emplace<CBounds>(entity, CBounds {{0, 0, 0, 0.5f}});
+        serial.add(entity, parent);
+        parallel.add(entity, parent);
+        nodes.push_back(entity);
+    }
+
+    WorkerPool pool {3};
+    serial.update(serial_registry);
+    parallel.update(parallel_registry, &pool);
+
+    REQUIRE(serial.recomputed() == nodes.size());
+    REQUIRE(parallel.recomputed() == nodes.size());
+    const auto& a = serial.worldMatrices();
+    const auto& b = parallel.worldMatrices();
+    REQUIRE(std::memcmp(a.data(), b.data(), a.size() * sizeof(glm::mat4)) == 0);
+
+    const auto& serial_bounds = serial.subtreeBounds();
+    const auto& parallel_bounds = parallel.subtreeBounds();
+    REQUIRE(std::memcmp(serial_bounds.data(), parallel_bounds.data(), serial_bounds.size() * sizeof(glm::vec4)) == 0);
+}
+
+TEST_CASE("TransformHierarchy subtree bounds") {
+    entt::registry registry;
+    TransformHierarchy hierarchy;
+    hierarchy.connect(registry);
+
+    // dos grupos de 100 hojas con esferas de radio 1: uno delante de la cámara y otro detrás.
+    const auto front = spawn(registry, hierarchy, entt::null, {0, 0, -20});
+    const auto back = spawn(registry, hierarchy, entt::null, {0, 0, 20});
+    std::vector<entt::entity> leaves;
+    for (auto group : {front, back}) {
+        for (int i = 0; i < 100; ++i) {
+            const auto leaf = spawn(registry, hierarchy, group, {float(i % 10) - 4.5f, float(i / 10) - 4.5f, 0});
+            registry.emplace<CBounds>(leaf, CBounds {{0, 0, 0, 1}});
+            leaves.push_back(leaf);
+        }
+    }
+    hierarchy.update(registry);
+
+    auto covers = [](const glm::vec4& outer, const glm::vec4& inner) {
+        const glm::vec3 d = glm::vec3(inner) - glm::vec3(outer);
+        return std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z) + inner.w <= outer.w * 1.0001f;
+    };
+    auto checkBounds = [&]() {
+        const auto& bounds = hierarchy.subtreeBounds();
+        for (auto leaf : leaves) {
+            const auto index = hierarchy.indexOf(leaf);
+            const auto root = hierarchy.indexOf(hierarchy.parent(leaf));
+            REQUIRE(covers(bounds[root], bounds[index]));
+        }
+    };
+    checkBounds();
+    REQUIRE(hierarchy.subtreeBounds()[hierarchy.indexOf(front)].w < 10.0f);
+
+    const glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+    const glm::mat4 proj = glm::perspectiveFov(glm::pi<float>() / 2.0f, 800.0f, 800.0f, 0.1f, 100.0f);
+    const Frustum frustum = frustumFromMatrix(proj * view);
+
+    // el grupo de atrás se descarta con una sola prueba.
+    std::vector<TransformHierarchy::Index> visible;
+    REQUIRE(hierarchy.cull(frustum, visible) == 2 + 100);
+    REQUIRE(visible.size() == 100);
+    for (auto index : visible)
+        REQUIRE(hierarchy.parents()[index] == hierarchy.indexOf(front));
+    REQUIRE(hierarchy.boundedCount() == 200);     // los grupos no tienen CBounds
+
+    SECTION("mover una hoja agranda la esfera del grupo") {
+        registry.patch<CTransform>(leaves[0], [](CTransform& transform) { transform.position.x = -30; });
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 1);
+        checkBounds();
+        REQUIRE(hierarchy.subtreeBounds()[hierarchy.indexOf(front)].w > 15.0f);
+    }
+
+    SECTION("sacar hojas achica la esfera del grupo") {
+        const float before = hierarchy.subtreeBounds()[hierarchy.indexOf(front)].w;
+        for (int i = 0; i < 50; ++i)
+            hierarchy.remove(leaves[i]);
+        leaves.erase(leaves.begin(), leaves.begin() + 50);
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.recomputed() == 0);
+        checkBounds();
+        REQUIRE(hierarchy.subtreeBounds()[hierarchy.indexOf(front)].w < before);
+        REQUIRE(hierarchy.boundedCount() == 150);
+    }
+
+    SECTION("sacar un CBounds lo descuenta") {
+        registry.remove<CBounds>(leaves[0]);
+        registry.emplace<CBounds>(front, CBounds {{0, 0, 0, 1}});
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.boundedCount() == 200);
+        registry.remove<CBounds>(leaves[1]);
+        hierarchy.update(registry);
+        REQUIRE(hierarchy.boundedCount() == 199);
+    }
+
+    SECTION("mover un grupo entero mueve su esfera") {
+        registry.patch<CTransform>(back, [](CTransform& transform) { transform.position.z = -20; });
+        hierarchy.update(registry);
+        checkBounds();
+        REQUIRE(hierarchy.cull(frustum, visible) == 2 + 200);
+        REQUIRE(visible.size() == 200);
+    }
+}
+
+TEST_CASE("WorkerPool") {
+    WorkerPool pool {3};
+    REQUIRE(pool.size() == 4);
+
+    for (std::size_t count : {0, 1, 7, 1000}) {
+        std::vector<std::atomic<int>> hits(count);
+        pool.run(count, [&hits](std::size_t i) { ++hits[i]; });
+        for (auto& hit : hits)
+            REQUIRE(hit == 1);
+    }
+}
+
+TEST_CASE("localMatrix vs glm") {
+    std::mt19937 rng {13};
+    std::uniform_real_distribution<float> angle {-20.0f, 20.0f};
+    std::uniform_real_distribution<float> value {-5.0f, 5.0f};
+
+    // una cantidad que no es múltiplo de 4 ni de 8, para pasar por la tanda incompleta.
+    std::vector<CTransform> transforms(1001);
+    std::vector<const CTransform*> pointers;
+    for (auto& transform : transforms) {
+        transform.position = {value(rng), value(rng), value(rng)};
+        transform.rotation = {angle(rng), angle(rng), angle(rng)};
+        transform.scale = {value(rng), value(rng), value(rng)};
+        pointers.push_back(&transform);
+    }
+
+    std::vector<glm::mat4> batch(transforms.size());
+    localMatrices(pointers.data(), pointers.size(), batch.data());
+
+    for (std::size_t i = 0; i < transforms.size(); ++i) {
+        const glm::mat4 reference = localMatrixGlm(transforms[i]);
+        REQUIRE(maxDifference(localMatrix(transforms[i]), reference) < 1e-5f);
+        REQUIRE(maxDifference(batch[i], reference) < 1e-5f);
+    }
+
+    SECTION("el resultado no depende de la tanda") {
+        glm::mat4 alone;
+        for (std::size_t i : {std::size_t(0), std::size_t(5), transforms.size() - 1}) {
+            localMatrices(&pointers[i], 1, &alone);
+            REQUIRE(std::memcmp(&alone, &batch[i], sizeof(glm::mat4)) == 0);
+        }
+    }
+
+    SECTION("ángulos exactos") {
+        CTransform transform;
+        transform.rotation = {0.0f, glm::pi<float>() / 2.0f, 0.0f};
+        const CTransform* pointer = &transform;
+        glm::mat4 matrix;
+        localMatrices(&pointer, 1, &matrix);
+        REQUIRE(maxDifference(matrix, localMatrixGlm(transform)) < 1e-6f);
+        REQUIRE(maxDifference(glm::mat4(1.0f), localMatrix(CTransform {})) == 0.0f);
+    }
+}
+
+TEST_CASE("Frustum culling") {
+    const glm::mat4 view = glm::lookAt(glm::vec3(0, 0, 0), glm::vec3(0, 0, -1), glm::vec3(0, 1, 0));
+    const glm::mat4 proj = glm::perspectiveFov(glm::pi<float>() / 2.0f, 800.0f, 800.0f, 0.1f, 100.0f);
+    const Frustum frustum = frustumFromMatrix(proj * view);
+
+    REQUIRE(intersects(frustum, {0, 0, -10, 0.5f}));
+    REQUIRE(intersects(frustum, {0, 0, -100.2f, 0.5f}));    // toca el plano lejano
+    REQUIRE_FALSE(intersects(frustum, {0, 0, 10, 0.5f}));   // detrás de la cámara
+    REQUIRE_FALSE(intersects(frustum, {0, 0, -101, 0.5f}));
+    REQUIRE_FALSE(intersects(frustum, {12, 0, -10, 1.0f})); // a la derecha (fov de 90°)
+    REQUIRE(intersects(frustum, {10.5f, 0, -10, 1.0f}));
+
+    SECTION("esferas transformadas") {
+        const glm::vec4 cube = boundingSphere(Cube::vertices, std::size(Cube::vertices), sizeof(Cube::Vertex));
+        REQUIRE(std::abs(cube.w - std::sqrt(0.75f)) < 1e-6f);
+
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), {1, 2, 3});
+        model = glm::scale(model, {1, 4, 2});
+        const glm::vec4 sphere = transformSphere(model, {0, 0, 0, 1});
+        REQUIRE(sphere == glm::vec4(1, 2, 3, 4));
+    }
+
+    SECTION("cullSpheres vs intersects") {
+        std::mt19937 rng {11};
+        std::uniform_real_distribution<float> value {-50.0f, 50.0f};
+        std::uniform_real_distribution<float> radius {0.0f, 5.0f};
+
+        // una cantidad que no es múltiplo de 4 ni de 8, para pasar por la tanda incompleta.
+        SphereSet spheres;
+        for (int i = 0; i < 1001; ++i)
+            spheres.add(glm::mat4(1.0f), {value(rng), value(rng), value(rng), radius(rng)});
+        spheres.add(glm::mat4(1.0f), {0, 0, 50, std::numeric_limits<float>::infinity()});
+
+        std::vector<std::uint8_t> visible(spheres.size());
+        const std::size_t count = cullSpheres(frustum, spheres, visible.data());
+
+        std::size_t expected = 0;
+        for (std::size_t i = 0; i < spheres.size(); ++i) {
+            REQUIRE(bool(visible[i]) == intersects(frustum, spheres[i]));
+            expected += visible[i];
+        }
+        REQUIRE(count == expected);
+        REQUIRE(visible.back());
+        REQUIRE(count > 0);
+        REQUIRE(count < spheres.size());
+    }
+}
+
+TEST_CASE("Profiler") {
+    Profiler profiler;
+    WorkerPool pool {3};
+    profiler.capture(2, 2);
+
+    for (int frame = 0; frame < 6; ++frame) {
+        profiler.beginFrame();
+        {
+            ProfileZone zone {"update", profiler};
+            pool.run(8, [&profiler](std::size_t) {
+                ProfileZone task {"tarea", profiler};
+            });
+        }
+        profiler.endFrame();
+        REQUIRE(profiler.captured() == (frame >= 3));
+    }
+
+    // por cuadro: "cuadro", "update" y 8 tareas, solo en los cuadros 2 y 3.
+    REQUIRE(profiler.eventCount() == 2 * 10);
+
+    std::ostringstream trace;
+    profiler.writeChromeTrace(trace);
+    const std::string json = trace.str();
+    REQUIRE(json.find("\"traceEvents\"") != std::string::npos);
+    REQUIRE(json.find("\"name\": \"tarea\", \"ph\": \"X\"") != std::string::npos);
+    REQUIRE(json.find("\"cuadro\": 3}") != std::string::npos);
+    REQUIRE(json.find("\"cuadro\": 4}") == std::string::npos);
+
+    SECTION("capturar de nuevo borra lo anterior") {
+        profiler.capture(100, 1);
+        REQUIRE(profiler.eventCount() == 0);
+    }
+}
+
+TEST_CASE("Vertex formats") {
+    SECTION("layouts") {
+        const VertexLayout full = vertexLayout(float_vertex_format);
+        REQUIRE(full.stride == sizeof(Cube::Vertex));
+        REQUIRE(full.attributes[1].offset == offsetof(Cube::Vertex, normal));
+        REQUIRE(full.attributes[2].offset == offsetof(Cube::Vertex, texCoord));
+
+        // posición: 3 halves + relleno, normal: 4 bytes, texCoord: 2 halves
+        const VertexLayout compact = vertexLayout(compact_vertex_format);
+        REQUIRE(compact.stride == 16);
+        REQUIRE(compact.attributes[0].offset == 0);
+        REQUIRE(compact.attributes[1].offset == 8);
+        REQUIRE(compact.attributes[1].type == GL_INT_2_10_10_10_REV);
+        REQUIRE(compact.attributes[2].offset == 12);
+
+        REQUIRE_THROWS_AS(vertexLayout({AttributeFormat::Float, AttributeFormat::Float, AttributeFormat::Snorm10}),
+                          std::invalid_argument);
+    }
+
+    SECTION("half") {
+        for (float value : {0.0f, -0.0f, 0.5f, -1.0f, 2.0f, 65504.0f, 0x1p-14f, 0x1p-24f})
+            REQUIRE(unpackHalf(packHalf(value)) == value);
+        REQUIRE(std::isinf(unpackHalf(packHalf(65520.0f))));
+        REQUIRE(unpackHalf(packHalf(65519.0f)) == 65504.0f);
+        REQUIRE(unpackHalf(packHalf(0x1p-26f)) == 0.0f);
+        REQUIRE(std::isnan(unpackHalf(packHalf(std::numeric_limits<float>::quiet_NaN()))));
+        REQUIRE(packHalf(1.0f + 0x1p-11f) == packHalf(1.0f));               // empate: al par
+        REQUIRE(packHalf(1.0f + 0x1p-11f + 0x1p-20f) == packHalf(1.0f) + 1);
+
+        std::mt19937 rng {5};
+        std::uniform_real_distribution<float> value {-100.0f, 100.0f};
+        for (int i = 0; i < 10000; ++i) {
+            const float v = value(rng);
+            REQUIRE(std::abs(unpackHalf(packHalf(v)) - v) <= std::abs(v) * 0x1p-11f);
+        }
+    }
+
+    SECTION("snorm10") {
+        REQUIRE(unpackSnorm10(packSnorm10({1, -1, 0})) == glm::vec3(1, -1, 0));
+        REQUIRE(unpackSnorm10(packSnorm10({2, -2, 0})) == glm::vec3(1, -1, 0));
+        REQUIRE(packSnorm10({0, 0, 0}) >> 30 == 0);
+
+        const glm::vec3 normal = glm::normalize(glm::vec3(0.3f, -0.5f, 0.8f));
+        const glm::vec3 error = glm::abs(unpackSnorm10(packSnorm10(normal)) - normal);
+        REQUIRE(std::max({error.x, error.y, error.z}) <= 0.5f / 511.0f + 1e-6f);
+    }
+
+    SECTION("packVertices") {
+        const VertexLayout layout = vertexLayout(compact_vertex_format);
+        const std::size_t count = std::size(Cube::vertices);
+        const auto packed = packVertices(layout, Cube::vertices, count);
+        REQUIRE(packed.size() == count * 16);
+
+        // el cubo es exacto en el formato compacto
+        for (std::size_t i = 0; i < count; ++i) {
+            const unsigned char* vertex = packed.data() + 16 * i;
+            std::uint16_t position[3], tex_coord[2];
+            std::uint32_t normal;
+            std::memcpy(position, vertex, sizeof(position));
+            std::memcpy(&normal, vertex + 8, sizeof(normal));
+            std::memcpy(tex_coord, vertex + 12, sizeof(tex_coord));
+
+            const Cube::Vertex& expected = Cube::vertices[i];
+            REQUIRE(glm::vec3(unpackHalf(position[0]), unpackHalf(position[1]), unpackHalf(position[2])) == expected.position);
+            REQUIRE(unpackSnorm10(normal) == expected.normal);
+            REQUIRE(glm::vec2(unpackHalf(tex_coord[0]), unpackHalf(tex_coord[1])) == expected.texCoord);
+        }
+
+        const auto full = packVertices(vertexLayout(float_vertex_format), Cube::vertices, count);
+        REQUIRE(std::memcmp(full.data(), Cube::vertices, sizeof(Cube::vertices)) == 0);
+    }
+
+    REQUIRE(indexType(24) == GL_UNSIGNED_SHORT);
+    REQUIRE(indexType(65536) == GL_UNSIGNED_SHORT);
+    REQUIRE(indexType(65537) == GL_UNSIGNED_INT);
+    REQUIRE(indexSize(GL_UNSIGNED_SHORT) == 2);
+}
+
+TEST_CASE("Mesh files") {
+    // un quad con los vértices compartidos y un triángulo con índices relativos (negativos)
+    std::istringstream obj {
+        "# comentario\n"
+        "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+        "vt 0 0\nvt 1 1\n"
+        "vn 0 0 1\n"
+        "f 1/1/1 2/1/1 3/2/1 4/2/1\n"
+        "f -4/1/1 -3/1/1 -2//1\n"
+        "o ignorado\n"
+    };
+    const ObjMesh mesh = loadObj(obj);
+    REQUIRE(mesh.indices == std::vector<std::uint32_t> {0, 1, 2, 0, 2, 3, 0, 1, 4});
+    REQUIRE(mesh.vertices.size() == 5);     // 3//1 no tiene texCoord: es otro vértice que 3/2/1
+    REQUIRE(mesh.vertices[2].texCoord == glm::vec2(1, 1));
+    REQUIRE(mesh.vertices[4].texCoord == glm::vec2(0, 0));
+    REQUIRE(mesh.vertices[3].normal == glm::vec3(0, 0, 1));
+
+    std::istringstream bad {"v 0 0 0\nf 1 2 3\n"};
+    REQUIRE_THROWS_AS(loadObj(bad), std::runtime_error);
+
+    SECTION("writeObj") {
+        std::stringstream text;
+        writeObj(text, mesh);
+        const ObjMesh copy = loadObj(text);
+        REQUIRE(copy.indices == mesh.indices);
+        REQUIRE(copy.vertices.size() == mesh.vertices.size());
+        REQUIRE(std::memcmp(copy.vertices.data(), mesh.vertices.data(), mesh.vertices.size() * sizeof(Cube::Vertex)) == 0);
+    }
+
+    SECTION(".mesh") {
+        const auto path = (std::filesystem::temp_directory_path() / "aux6_test.mesh").string();
+        const VertexLayout layout = vertexLayout(compact_vertex_format);
+        const auto vertices = packVertices(layout, mesh.vertices.data(), mesh.vertices.size());
+        REQUIRE(writeMeshFile(path, layout, vertices.data(), mesh.vertices.size(), mesh.indices, {0.5f, 0.5f, 0, 1}));
+
+        {
+            const MeshFile file {path};
+            REQUIRE(file.layout() == layout);
+            REQUIRE(file.vertexCount() == 5);
+            REQUIRE(file.indexCount() == 9);
+            REQUIRE(file.indexType() == GL_UNSIGNED_SHORT);
+            REQUIRE(file.bounds() == glm::vec4(0.5f, 0.5f, 0, 1));
+            REQUIRE(reinterpret_cast<std::uintptr_t>(file.vertices()) % 16 == 0);
+            REQUIRE(reinterpret_cast<std::uintptr_t>(file.indices()) % 16 == 0);
+            REQUIRE(std::memcmp(file.vertices(), vertices.data(), vertices.size()) == 0);
+
+            std::uint16_t indices[9];
+            std::memcpy(indices, file.indices(), sizeof(indices));
+            REQUIRE(std::equal(std::begin(indices), std::end(indices), mesh.indices.begin()));
+        }
+
+        // un índice que apunta más allá de los vértices
+        {
+            auto indices = mesh.indices;
+            indices.back() = std::uint32_t(mesh.vertices.size());
+            REQUIRE(writeMeshFile(path, layout, vertices.data(), mesh.vertices.size(), indices, {0.5f, 0.5f, 0, 1}));
+            REQUIRE_THROWS_AS(MeshFile(path), std::runtime_error);
+            REQUIRE(writeMeshFile(path, layout, vertices.data(), mesh.vertices.size(), mesh.indices, {0.5f, 0.5f, 0, 1}));
+        }
+
+        // truncado: la cabecera promete más índices de los que hay
+        std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+        REQUIRE_THROWS_AS(MeshFile(path), std::runtime_error);
+
+        std::ofstream {path, std::ios::binary} << "no es un mesh";
+        REQUIRE_THROWS_AS(MeshFile(path), std::runtime_error);
+        std::filesystem::remove(path);
+        REQUIRE_THROWS_AS(MeshFile(path), std::runtime_error);
+    }
+}
+
+TEST_CASE("StreamBuffer frame size") {
+    // lo que hace allocate() al crecer: 40001 instancias de 80 bytes con alineación de 256 no
+    // caben en una región de 1 MiB
+    constexpr GLsizeiptr alignment = 256;
+    constexpr GLsizeiptr request = 40'001 * 80;
+    const GLsizeiptr frame_size = alignedFrameSize(std::max<GLsizeiptr>(2 << 20, request + alignment), alignment);
+    REQUIRE(frame_size >= request + alignment);
+    REQUIRE(alignedFrameSize(request + alignment, alignment) == 3'200'512);
+    REQUIRE((request + alignment) % alignment != 0);    // sin redondear, la región 1 queda desalineada
+
+    for (GLsizeiptr frame = 0; frame < 3; ++frame) {
+        const GLsizeiptr region = frame * frame_size;
+        REQUIRE(region % alignment == 0);
+        REQUIRE(region % 64 == 0);      // también sirve para alineaciones menores
+    }
+
+    REQUIRE(alignedFrameSize(0, 256) == 0);
+    REQUIRE(alignedFrameSize(1, 256) == 256);
+    REQUIRE(alignedFrameSize(256, 256) == 256);
+}
\ No newline at end of file
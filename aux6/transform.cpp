@@ -0,0 +1,198 @@
+#include "transform.hpp"
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#define AUX6_TRANSFORM_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#define AUX6_TRANSFORM_SSE2
+#endif
+
+#if defined(AUX6_TRANSFORM_AVX2) || defined(AUX6_TRANSFORM_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/* operaciones sobre un "vector" de lanes floats: __m256 con AVX2, __m128 con SSE2 y un float
+ * solo si no hay ninguno de los dos. composeLanes() está escrita una vez encima de estas.
+ */
+#if defined(AUX6_TRANSFORM_AVX2)
+
+constexpr std::size_t lanes = 8;
+using Float = __m256;
+using Int = __m256i;
+
+inline Float load(const float* p) { return _mm256_load_ps(p); }
+inline void store(float* p, Float v) { _mm256_store_ps(p, v); }
+inline Float set1(float x) { return _mm256_set1_ps(x); }
+inline Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+inline Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+inline Float bitAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+inline Float bitAndNot(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+inline Float bitXor(Float a, Float b) { return _mm256_xor_ps(a, b); }
+inline Float select(Float mask, Float a, Float b) { return _mm256_blendv_ps(b, a, mask); }
+inline Int set1i(int x) { return _mm256_set1_epi32(x); }
+inline Int toInt(Float a) { return _mm256_cvttps_epi32(a); }
+inline Float toFloat(Int a) { return _mm256_cvtepi32_ps(a); }
+inline Int addi(Int a, Int b) { return _mm256_add_epi32(a, b); }
+inline Int subi(Int a, Int b) { return _mm256_sub_epi32(a, b); }
+inline Int andi(Int a, Int b) { return _mm256_and_si256(a, b); }
+inline Int andNoti(Int a, Int b) { return _mm256_andnot_si256(a, b); }
+inline Int shiftLeft29(Int a) { return _mm256_slli_epi32(a, 29); }
+inline Float isZero(Int a) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, _mm256_setzero_si256())); }
+inline Float asFloat(Int a) { return _mm256_castsi256_ps(a); }
+
+#elif defined(AUX6_TRANSFORM_SSE2)
+
+constexpr std::size_t lanes = 4;
+using Float = __m128;
+using Int = __m128i;
+
+inline Float load(const float* p) { return _mm_load_ps(p); }
+inline void store(float* p, Float v) { _mm_store_ps(p, v); }
+inline Float set1(float x) { return _mm_set1_ps(x); }
+inline Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+inline Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+inline Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+inline Float bitAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+inline Float bitAndNot(Float a, Float b) { return _mm_andnot_ps(a, b); }
+inline Float bitXor(Float a, Float b) { return _mm_xor_ps(a, b); }
+inline Float select(Float mask, Float a, Float b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+inline Int set1i(int x) { return _mm_set1_epi32(x); }
+inline Int toInt(Float a) { return _mm_cvttps_epi32(a); }
+inline Float toFloat(Int a) { return _mm_cvtepi32_ps(a); }
+inline Int addi(Int a, Int b) { return _mm_add_epi32(a, b); }
+inline Int subi(Int a, Int b) { return _mm_sub_epi32(a, b); }
+inline Int andi(Int a, Int b) { return _mm_and_si128(a, b); }
+inline Int andNoti(Int a, Int b) { return _mm_andnot_si128(a, b); }
+inline Int shiftLeft29(Int a) { return _mm_slli_epi32(a, 29); }
+inline Float isZero(Int a) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, _mm_setzero_si128())); }
+inline Float asFloat(Int a) { return _mm_castsi128_ps(a); }
+
+#else
+
+constexpr std::size_t lanes = 1;
+using Float = float;
+
+inline Float load(const float* p) { return *p; }
+inline void store(float* p, Float v) { *p = v; }
+inline Float set1(float x) { return x; }
+inline Float add(Float a, Float b) { return a + b; }
+inline Float sub(Float a, Float b) { return a - b; }
+inline Float mul(Float a, Float b) { return a * b; }
+
+#endif
+
+#if defined(AUX6_TRANSFORM_AVX2) || defined(AUX6_TRANSFORM_SSE2)
+
+/* seno y coseno de los mismos ángulos a la vez (algoritmo de Cephes, como sse_mathfun).
+ *
+ * Reduce |x| a [-pi/4, pi/4] restando un múltiplo de pi/4 en tres partes (para no perder
+ * precisión), evalúa los polinomios de seno y coseno y elige y corrige el signo según el
+ * octante. Error de ~1 ulp para |x| hasta unos miles de radianes.
+ */
+inline void sincos(Float x, Float& s, Float& c) {
+    const Float sign_mask = asFloat(set1i(int(0x80000000u)));
+    Float sign_sin = bitAnd(x, sign_mask);
+    x = bitAndNot(sign_mask, x);
+
+    // octante j (redondeado a par) y x reducido
+    Int j = toInt(mul(x, set1(1.27323954473516f)));     // 4 / pi
+    j = andi(addi(j, set1i(1)), set1i(~1));
+    const Float y = toFloat(j);
+
+    sign_sin = bitXor(sign_sin, asFloat(shiftLeft29(andi(j, set1i(4)))));
+    const Float sign_cos = asFloat(shiftLeft29(andNoti(subi(j, set1i(2)), set1i(4))));
+    const Float use_sin_poly = isZero(andi(j, set1i(2)));
+
+    x = sub(x, mul(y, set1(0.78515625f)));
+    x = sub(x, mul(y, set1(2.4187564849853515625e-4f)));
+    x = sub(x, mul(y, set1(3.77489497744594108e-8f)));
+    const Float z = mul(x, x);
+
+    Float poly_cos = set1(2.443315711809948e-5f);
+    poly_cos = add(mul(poly_cos, z), set1(-1.388731625493765e-3f));
+    poly_cos = add(mul(poly_cos, z), set1(4.166664568298827e-2f));
+    poly_cos = mul(mul(poly_cos, z), z);
+    poly_cos = add(sub(poly_cos, mul(z, set1(0.5f))), set1(1.0f));
+
+    Float poly_sin = set1(-1.9515295891e-4f);
+    poly_sin = add(mul(poly_sin, z), set1(8.3321608736e-3f));
+    poly_sin = add(mul(poly_sin, z), set1(-1.6666654611e-1f));
+    poly_sin = add(mul(mul(poly_sin, z), x), x);
+
+    s = bitXor(select(use_sin_poly, poly_sin, poly_cos), sign_sin);
+    c = bitXor(select(use_sin_poly, poly_cos, poly_sin), sign_cos);
+}
+
+#else
+
+inline void sincos(Float x, Float& s, Float& c) {
+    s = std::sin(x);
+    c = std::cos(x);
+}
+
+#endif
+
+// entradas y salidas en SoA: in[k][lane] con k = rotación xyz, escala xyz; out[k][lane] con
+// los 9 coeficientes de la parte 3x3 de la matriz, por columnas.
+void composeLanes(const float (&in)[6][lanes], float (&out)[9][lanes]) {
+    Float sx, cx, sy, cy, sz, cz;
+    sincos(load(in[0]), sx, cx);
+    sincos(load(in[1]), sy, cy);
+    sincos(load(in[2]), sz, cz);
+    const Float scale_x = load(in[3]);
+    const Float scale_y = load(in[4]);
+    const Float scale_z = load(in[5]);
+
+    const Float sy_sx = mul(sy, sx);
+    const Float cy_sx = mul(cy, sx);
+
+    store(out[0], mul(add(mul(cy, cz), mul(sy_sx, sz)), scale_x));
+    store(out[1], mul(mul(cx, sz), scale_x));
+    store(out[2], mul(sub(mul(cy_sx, sz), mul(sy, cz)), scale_x));
+
+    store(out[3], mul(sub(mul(sy_sx, cz), mul(cy, sz)), scale_y));
+    store(out[4], mul(mul(cx, cz), scale_y));
+    store(out[5], mul(add(mul(sy, sz), mul(cy_sx, cz)), scale_y));
+
+    store(out[6], mul(mul(sy, cx), scale_z));
+    store(out[7], mul(sub(set1(0.0f), sx), scale_z));
+    store(out[8], mul(mul(cy, cx), scale_z));
+}
+
+}
+
+const std::size_t transform_lanes = lanes;
+
+void localMatrices(const CTransform* const* transforms, std::size_t count, glm::mat4* out) {
+    alignas(32) float in[6][lanes];
+    alignas(32) float coefficients[9][lanes];
+
+    for (std::size_t first = 0; first < count; first += lanes) {
+        const std::size_t n = std::min(lanes, count - first);
+
+        for (std::size_t lane = 0; lane < lanes; ++lane) {
+            const CTransform& transform = *transforms[first + std::min(lane, n - 1)];
+            for (int k = 0; k < 3; ++k) {
+                in[k][lane] = transform.rotation[k];
+                in[3 + k][lane] = transform.scale[k];
+            }
+        }
+
+        composeLanes(in, coefficients);
+
+        for (std::size_t lane = 0; lane < n; ++lane) {
+            glm::mat4& matrix = out[first + lane];
+            for (int column = 0; column < 3; ++column) {
+                matrix[column] = {coefficients[3 * column][lane],
+                                  coefficients[3 * column + 1][lane],
+                                  coefficients[3 * column + 2][lane],
+                                  0.0f};
+            }
+            matrix[3] = glm::vec4(transforms[first + lane]->position, 1.0f);
+        }
+    }
+}
\ No newline at end of file
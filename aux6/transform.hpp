@@ -0,0 +1,61 @@
+#ifndef AUX6__TRANSFORM_HPP
+#define AUX6__TRANSFORM_HPP
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <cstddef>
+
+// Transformación
+struct CTransform {
+    glm::vec3 position {0, 0, 0};
+    glm::vec3 rotation {0, 0, 0};
+    glm::vec3 scale {1, 1, 1};
+    glm::mat4 matrix {1.0f};
+};
+
+/* matriz local (relativa al padre): traslación, rotaciones en y, x, z (en ese orden) y escala.
+ *
+ * T * Ry * Rx * Rz * S se arma directamente a partir de los senos y cosenos de los ángulos, en
+ * lugar de multiplicar cinco matrices de 4x4 como hace localMatrixGlm(), que queda como
+ * referencia para los tests y benchmarks.
+ */
+inline glm::mat4 localMatrix(const CTransform& transform) {
+    const float sx = std::sin(transform.rotation.x), cx = std::cos(transform.rotation.x);
+    const float sy = std::sin(transform.rotation.y), cy = std::cos(transform.rotation.y);
+    const float sz = std::sin(transform.rotation.z), cz = std::cos(transform.rotation.z);
+    const glm::vec3& s = transform.scale;
+    const glm::vec3& p = transform.position;
+
+    return {
+        {(cy * cz + sy * sx * sz) * s.x, cx * sz * s.x, (cy * sx * sz - sy * cz) * s.x, 0.0f},
+        {(sy * sx * cz - cy * sz) * s.y, cx * cz * s.y, (sy * sz + cy * sx * cz) * s.y, 0.0f},
+        {sy * cx * s.z, -sx * s.z, cy * cx * s.z, 0.0f},
+        {p.x, p.y, p.z, 1.0f}
+    };
+}
+
+inline glm::mat4 localMatrixGlm(const CTransform& transform) {
+    glm::mat4 matrix {1.0f};
+    matrix = glm::translate(matrix, transform.position);
+    matrix = glm::rotate(matrix, transform.rotation.y, {0, 1, 0});
+    matrix = glm::rotate(matrix, transform.rotation.x, {1, 0, 0});
+    matrix = glm::rotate(matrix, transform.rotation.z, {0, 0, 1});
+    matrix = glm::scale(matrix, transform.scale);
+    return matrix;
+}
+
+/* localMatrices
+ *
+ * Lo mismo que localMatrix() para count transformaciones, de a transform_lanes a la vez con
+ * SSE2 (4) o AVX2 (8, compilando con AUX6_AVX2), incluyendo seno y coseno vectorizados. La
+ * última tanda se completa repitiendo la última transformación, así que el resultado de cada
+ * una no depende de con cuáles se agrupó.
+ */
+extern const std::size_t transform_lanes;
+
+void localMatrices(const CTransform* const* transforms, std::size_t count, glm::mat4* out);
+
+#endif //AUX6__TRANSFORM_HPP
\ No newline at end of file
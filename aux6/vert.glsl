@@ -7,8 +7,13 @@ out vec3 position;
 //out vec3 normal;
 
 layout (location = 0) uniform mat4 u_model;
-layout (location = 1) uniform mat4 u_view;
-layout (location = 2) uniform mat4 u_proj;
+
+layout(std140, binding = 0) uniform FrameConstants {
+    mat4 u_view;
+    mat4 u_proj;
+    mat4 u_view_proj;
+    vec4 u_camera_position;
+};
 
 void main() {
     gl_Position = u_proj * u_view * u_model * vec4(a_position, 1.0f);
@@ -0,0 +1,30 @@
+#version 460
+
+layout(location = 0) in vec3 a_position;
+layout(location = 1) in vec3 a_normal;
+
+out vec3 position;
+out flat vec4 color;
+
+struct Instance {
+    mat4 model;
+    vec4 color;
+};
+
+layout(std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(std140, binding = 0) uniform FrameConstants {
+    mat4 u_view;
+    mat4 u_proj;
+    mat4 u_view_proj;
+    vec4 u_camera_position;
+};
+
+void main() {
+    Instance instance = instances[gl_BaseInstance + gl_InstanceID];
+    gl_Position = u_proj * u_view * instance.model * vec4(a_position, 1.0f);
+    position = a_position;
+    color = instance.color;
+}
\ No newline at end of file
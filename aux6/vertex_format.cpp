@@ -0,0 +1,182 @@
+#include "vertex_format.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+struct AttributeType {
+    GLenum type;
+    GLboolean normalized;
+    GLint size;
+    GLuint bytes;
+};
+
+AttributeType attributeType(AttributeFormat format, GLint components) {
+    switch (format) {
+        case AttributeFormat::Float:
+            return {GL_FLOAT, GL_FALSE, components, GLuint(4 * components)};
+        case AttributeFormat::Half:
+            return {GL_HALF_FLOAT, GL_FALSE, components, GLuint(2 * components)};
+        case AttributeFormat::Snorm16:
+            return {GL_SHORT, GL_TRUE, components, GLuint(2 * components)};
+        case AttributeFormat::Snorm10:
+            if (components != 3)
+                throw std::invalid_argument("vertexLayout: Snorm10 solo sirve para atributos vec3");
+            // GL pide size 4 con este tipo; w queda en 0 y el shader lo ignora con `in vec3`
+            return {GL_INT_2_10_10_10_REV, GL_TRUE, 4, 4};
+    }
+    throw std::invalid_argument("vertexLayout: formato desconocido");
+}
+
+// componentes de cada location en Cube::Vertex: position, normal y texCoord
+const float* source(const Cube::Vertex& vertex, GLuint location, int& components) {
+    switch (location) {
+        case 0: components = 3; return &vertex.position.x;
+        case 1: components = 3; return &vertex.normal.x;
+        case 2: components = 2; return &vertex.texCoord.x;
+        default: throw std::invalid_argument("packVertices: location sin atributo en Cube::Vertex");
+    }
+}
+
+void packAttribute(const VertexAttribute& attribute, const float* value, int components, unsigned char* out) {
+    switch (attribute.type) {
+        case GL_FLOAT:
+            std::memcpy(out, value, components * sizeof(float));
+            return;
+        case GL_HALF_FLOAT:
+            for (int i = 0; i < components; ++i) {
+                const std::uint16_t half = packHalf(value[i]);
+                std::memcpy(out + 2 * i, &half, 2);
+            }
+            return;
+        case GL_SHORT:
+            for (int i = 0; i < components; ++i) {
+                const auto snorm = std::int16_t(std::lround(std::clamp(value[i], -1.0f, 1.0f) * 32767.0f));
+                std::memcpy(out + 2 * i, &snorm, 2);
+            }
+            return;
+        case GL_INT_2_10_10_10_REV: {
+            const std::uint32_t packed = packSnorm10({value[0], value[1], value[2]});
+            std::memcpy(out, &packed, 4);
+            return;
+        }
+        default:
+            throw std::invalid_argument("packVertices: tipo de atributo no soportado");
+    }
+}
+
+}
+
+bool operator==(const VertexLayout& a, const VertexLayout& b) {
+    return a.stride == b.stride && std::equal(a.attributes.begin(), a.attributes.end(), b.attributes.begin(), b.attributes.end(),
+        [](const VertexAttribute& x, const VertexAttribute& y) {
+            return x.location == y.location && x.size == y.size && x.type == y.type
+                && x.normalized == y.normalized && x.offset == y.offset;
+        });
+}
+
+VertexLayout vertexLayout(const VertexFormat& format) {
+    VertexLayout layout {0, {}};
+    const std::pair<AttributeFormat, GLint> attributes[] {
+        {format.position, 3}, {format.normal, 3}, {format.tex_coord, 2}
+    };
+
+    GLuint offset = 0;
+    for (GLuint location = 0; location < 3; ++location) {
+        const auto type = attributeType(attributes[location].first, attributes[location].second);
+        layout.attributes.push_back({location, type.size, type.type, type.normalized, offset});
+        offset += (type.bytes + 3) / 4 * 4;
+    }
+    layout.stride = GLsizei(offset);
+    return layout;
+}
+
+std::vector<unsigned char> packVertices(const VertexLayout& layout, const Cube::Vertex* vertices, std::size_t count) {
+    std::vector<unsigned char> packed(std::size_t(layout.stride) * count);
+    for (std::size_t i = 0; i < count; ++i) {
+        unsigned char* vertex = packed.data() + i * std::size_t(layout.stride);
+        for (const auto& attribute : layout.attributes) {
+            int components;
+            const float* value = source(vertices[i], attribute.location, components);
+            packAttribute(attribute, value, components, vertex + attribute.offset);
+        }
+    }
+    return packed;
+}
+
+GLenum indexType(std::size_t vertex_count) {
+    return vertex_count <= 0x10000 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+std::size_t indexSize(GLenum index_type) {
+    switch (index_type) {
+        case GL_UNSIGNED_BYTE: return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        default: return 4;
+    }
+}
+
+std::uint16_t packHalf(float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const auto sign = std::uint16_t((bits >> 16) & 0x8000u);
+    const std::uint32_t magnitude = bits & 0x7FFFFFFFu;
+
+    if (magnitude >= 0x7F800000u)       // infinito o NaN
+        return std::uint16_t(sign | 0x7C00u | (magnitude > 0x7F800000u ? 0x200u : 0u));
+    if (magnitude >= 0x477FF000u)       // desde 65520 redondea a infinito
+        return std::uint16_t(sign | 0x7C00u);
+
+    // redondeo al más cercano, empates al par
+    auto round = [](std::uint32_t value, std::uint32_t rest, std::uint32_t halfway) {
+        return value + (rest > halfway || (rest == halfway && (value & 1u)));
+    };
+
+    if (magnitude < 0x38800000u) {      // menor que 2^-14: subnormal en half
+        if (magnitude < 0x33000000u)    // menor que 2^-25: cero
+            return sign;
+        const std::uint32_t mantissa = (magnitude & 0x7FFFFFu) | 0x800000u;
+        const std::uint32_t shift = 126u - (magnitude >> 23);
+        return sign | std::uint16_t(round(mantissa >> shift, mantissa & ((1u << shift) - 1u), 1u << (shift - 1u)));
+    }
+
+    // exponente de 127 a 15 de sesgo; el acarreo del redondeo pasa bien al exponente
+    return sign | std::uint16_t(round((magnitude >> 13) - (112u << 10), magnitude & 0x1FFFu, 0x1000u));
+}
+
+float unpackHalf(std::uint16_t half) {
+    const std::uint32_t sign = std::uint32_t(half & 0x8000u) << 16;
+    const std::uint32_t exponent = (half >> 10) & 0x1Fu;
+    const std::uint32_t mantissa = half & 0x3FFu;
+
+    if (exponent == 0)
+        return std::copysign(std::ldexp(float(mantissa), -24), sign ? -1.0f : 1.0f);
+
+    const std::uint32_t bits = exponent == 0x1F ? sign | 0x7F800000u | (mantissa << 13)
+                                                : sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::uint32_t packSnorm10(const glm::vec3& value) {
+    std::uint32_t packed = 0;
+    for (int i = 0; i < 3; ++i) {
+        const auto snorm = std::int32_t(std::lround(std::clamp(value[i], -1.0f, 1.0f) * 511.0f));
+        packed |= (std::uint32_t(snorm) & 0x3FFu) << (10 * i);
+    }
+    return packed;
+}
+
+glm::vec3 unpackSnorm10(std::uint32_t packed) {
+    glm::vec3 value;
+    for (int i = 0; i < 3; ++i) {
+        // extiende el signo de los 10 bits
+        const auto snorm = std::int32_t(packed << (22 - 10 * i)) >> 22;
+        value[i] = std::max(float(snorm) / 511.0f, -1.0f);
+    }
+    return value;
+}
\ No newline at end of file
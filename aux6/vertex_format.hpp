@@ -0,0 +1,75 @@
+#ifndef AUX6__VERTEX_FORMAT_HPP
+#define AUX6__VERTEX_FORMAT_HPP
+
+#include <glad/glad.h>
+
+#include <glm/vec3.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "cube.hpp"
+
+
+// un atributo de vértice: `in` en la location dada, leído desde offset dentro de cada vértice.
+struct VertexAttribute {
+    GLuint location;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    GLuint offset;
+};
+
+struct VertexLayout {
+    GLsizei stride;
+    std::vector<VertexAttribute> attributes;
+};
+
+bool operator==(const VertexLayout& a, const VertexLayout& b);
+
+/* formatos de vértice.
+ *
+ * Los meshes se escriben con floats (Cube::Vertex, 32 bytes por vértice) y se empaquetan al
+ * subirlos. vertexLayout() arma el VertexLayout de un formato y packVertices() escribe los
+ * vértices según ese layout, así que ambos nunca quedan desalineados. Los shaders no cambian:
+ * GL convierte cada atributo a float al leerlo.
+ *
+ * compact_vertex_format usa 16 bytes: posición en half float (error relativo < 2^-11),
+ * normal en 2_10_10_10 (error < 1/511) y texCoord en half. Snorm16 da más precisión a las
+ * posiciones, pero solo admite valores en [-1, 1]; con un rango mayor habría que escalar el
+ * mesh y deshacer la escala en el shader.
+ */
+enum class AttributeFormat {
+    Float,          // GL_FLOAT
+    Half,           // GL_HALF_FLOAT
+    Snorm16,        // GL_SHORT normalizado
+    Snorm10,        // GL_INT_2_10_10_10_REV normalizado, solo para vec3
+};
+
+struct VertexFormat {
+    AttributeFormat position {AttributeFormat::Float};
+    AttributeFormat normal {AttributeFormat::Float};
+    AttributeFormat tex_coord {AttributeFormat::Float};
+};
+
+constexpr VertexFormat float_vertex_format {};
+constexpr VertexFormat compact_vertex_format {AttributeFormat::Half, AttributeFormat::Snorm10, AttributeFormat::Half};
+
+// position en la location 0, normal en la 1 y texCoord en la 2, cada una alineada a 4 bytes.
+VertexLayout vertexLayout(const VertexFormat& format);
+
+// count vértices en el formato de layout (layout.stride * count bytes).
+std::vector<unsigned char> packVertices(const VertexLayout& layout, const Cube::Vertex* vertices, std::size_t count);
+
+// GL_UNSIGNED_SHORT si los índices de un mesh con vertex_count vértices caben en 16 bits.
+GLenum indexType(std::size_t vertex_count);
+std::size_t indexSize(GLenum index_type);
+
+// conversiones de packVertices()
+std::uint16_t packHalf(float value);
+float unpackHalf(std::uint16_t half);
+std::uint32_t packSnorm10(const glm::vec3& value);
+glm::vec3 unpackSnorm10(std::uint32_t packed);
+
+#endif //AUX6__VERTEX_FORMAT_HPP
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "worker_pool.hpp"
+
+WorkerPool::WorkerPool(std::size_t threads) {
+    m_threads.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+        m_threads.emplace_back(&WorkerPool::work, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+std::size_t WorkerPool::size() const {
+    return m_threads.size() + 1;
+}
+
+void WorkerPool::run(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0)
+        return;
+
+    // una sola tarea, o ningún hilo: no vale la pena despertar a nadie.
+    if (count == 1 || m_threads.empty()) {
+        for (std::size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {m_mutex};
+        m_task = &task;
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_working = m_threads.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    drain();
+
+    // cada hilo pasa por cada generación, así que nadie puede seguir usando m_task al salir.
+    std::unique_lock<std::mutex> lock {m_mutex};
+    m_done.wait(lock, [this]() { return m_working == 0; });
+    m_task = nullptr;
+}
+
+std::size_t WorkerPool::defaultThreads() {
+    const unsigned cores = std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 0;
+}
+
+void WorkerPool::work() {
+    std::size_t generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock {m_mutex};
+            m_wake.wait(lock, [this, generation]() { return m_stop || m_generation != generation; });
+            if (m_stop)
+                return;
+            generation = m_generation;
+        }
+
+        drain();
+
+        std::lock_guard<std::mutex> lock {m_mutex};
+        if (--m_working == 0)
+            m_done.notify_one();
+    }
+}
+
+void WorkerPool::drain() {
+    for (std::size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count;
+         i = m_next.fetch_add(1, std::memory_order_relaxed))
+        (*m_task)(i);
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#ifndef AUX6__WORKER_POOL_HPP
+#define AUX6__WORKER_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* pool de hilos para paralelizar un for.
+ *
+ * run(count, task) ejecuta task(0) ... task(count - 1) repartidas entre los hilos del pool y el
+ * hilo que llama, y retorna cuando terminaron todas. Las tareas se reclaman de a una con un
+ * contador atómico, así que conviene que sean varias veces más que los hilos para balancear.
+ *
+ * Los hilos se crean una vez y duermen en una condition_variable entre llamadas.
+ */
+class WorkerPool {
+public:
+    // threads hilos además del que llama a run(); por defecto uno por núcleo.
+    explicit WorkerPool(std::size_t threads = defaultThreads());
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // hilos que ejecutan tareas, contando al que llama a run().
+    std::size_t size() const;
+
+    void run(std::size_t count, const std::function<void(std::size_t)>& task);
+
+    static std::size_t defaultThreads();
+
+private:
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    std::size_t m_generation {0};
+    std::size_t m_working {0};
+    bool m_stop {false};
+
+    const std::function<void(std::size_t)>* m_task {nullptr};
+    std::size_t m_count {0};
+    std::atomic<std::size_t> m_next {0};
+
+    void work();
+    void drain();
+};
+
+#endif //AUX6__WORKER_POOL_HPP
\ No newline at end of file